@@ -0,0 +1,110 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+// link with -lpsapi
+#include <psapi.h>
+#endif
+#define GLFW_DLL
+#include <GLFW/glfw3.h>
+
+// creates an invisible 4.6 core context so benchmarks can run without showing a window
+inline GLFWwindow *createBenchContext() {
+    if (!glfwInit()) {
+        fprintf(stderr, "Failed to initialize GLFW\n");
+        return NULL;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "bench", NULL, NULL);
+    if (window == NULL) {
+        fprintf(stderr, "Failed to open GLFW window\n");
+        glfwTerminate();
+        return NULL;
+    }
+    glfwMakeContextCurrent(window);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        fprintf(stderr, "Failed to initialize OpenGL context\n");
+        glfwTerminate();
+        return NULL;
+    }
+    return window;
+}
+
+// wall clock stopwatch in milliseconds
+class BenchTimer {
+   public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    double elapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void reset() {
+        start = std::chrono::steady_clock::now();
+    }
+
+   private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// resident memory of the process in bytes, peak is the high water mark since start (or resetPeakMemory)
+struct MemoryUsage {
+    size_t current = 0;
+    size_t peak = 0;
+};
+
+inline MemoryUsage memoryUsage() {
+    MemoryUsage usage;
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        usage.current = counters.WorkingSetSize;
+        usage.peak = counters.PeakWorkingSetSize;
+    }
+#else
+    FILE *status = fopen("/proc/self/status", "r");
+    if (status) {
+        char line[256];
+        size_t kb;
+        while (fgets(line, sizeof(line), status)) {
+            if (sscanf(line, "VmRSS: %zu kB", &kb) == 1)
+                usage.current = kb * 1024;
+            else if (sscanf(line, "VmHWM: %zu kB", &kb) == 1)
+                usage.peak = kb * 1024;
+        }
+        fclose(status);
+    }
+#endif
+    return usage;
+}
+
+// restarts the peak measurement where the platform allows it (Linux), returns false otherwise
+inline bool resetPeakMemory() {
+#ifdef _WIN32
+    return false;
+#else
+    FILE *refs = fopen("/proc/self/clear_refs", "w");
+    if (!refs)
+        return false;
+    bool reset = fputs("5", refs) >= 0;
+    return fclose(refs) == 0 && reset;
+#endif
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,170 @@
+// Draw call benchmark: CPU time per Mesh::Draw for thousands of small meshes drawn with the multilight shader, the
+// way Mesh::Draw worked before (building "material.texture_diffuseN" strings and looking them up, glActiveTexture and
+// glBindTexture for every texture, resetting the VAO and the active unit after each draw) against the current path
+// (sampler locations resolved once per mesh and shader, unchanged samplers and bindings skipped through GLState).
+// then the same count of one mesh placed by a model uniform per draw against one instanced draw (Mesh::DrawInstanced).
+// the time is the submission only, the GPU work is waited for outside of it.
+// usage: draw [meshes] [frames], defaults 4096 and 50. run from the repository root so shaders/ can be found
+#include "bench.h"
+
+#include <glfwterminator.h>
+#include <glstate.h>
+#include <instancebuffer.h>
+#include <mesh.h>
+#include <shader.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const unsigned int TEXTURE_COUNT = 16;
+
+// what Mesh::Draw did per call before the bindings were cached
+static void drawUncached(Mesh &mesh, Shader &shader) {
+    unsigned int diffuseNr = 1;
+    unsigned int specularNr = 1;
+    unsigned int normalNr = 1;
+    unsigned int heightNr = 1;
+    std::string prefix = "material.";
+    for (unsigned int i = 0; i < mesh.textures.size(); i++) {
+        glActiveTexture(GL_TEXTURE0 + i);
+        std::string number;
+        std::string name = mesh.textures[i].type;
+        if (name == "texture_diffuse")
+            number = std::to_string(diffuseNr++);
+        else if (name == "texture_specular")
+            number = std::to_string(specularNr++);
+        else if (name == "texture_normal")
+            number = std::to_string(normalNr++);
+        else if (name == "texture_height")
+            number = std::to_string(heightNr++);
+        shader.set1i(prefix + name + number, i);
+        glBindTexture(GL_TEXTURE_2D, mesh.textures[i].id);
+    }
+    glBindVertexArray(mesh.VAO);
+    glDrawElements(GL_TRIANGLES, mesh.indexCount, mesh.indexType, 0);
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+// one quad per mesh, every mesh with a diffuse and a specular texture out of a small set so neighbours differ
+static std::vector<Mesh> makeMeshes(size_t count, const std::vector<unsigned int> &textureIds) {
+    std::vector<Mesh> meshes;
+    meshes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        float x = -1.0f + 2.0f * (float)(i % 64) / 64.0f, y = -1.0f + 2.0f * (float)(i / 64 % 64) / 64.0f, size = 2.0f / 64.0f;
+        std::vector<Vertex> vertices(4);
+        glm::vec2 corners[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+        for (int c = 0; c < 4; c++) {
+            vertices[c].Position = glm::vec3(x + corners[c].x * size, y + corners[c].y * size, 0.0f);
+            vertices[c].Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+            vertices[c].TexCoords = corners[c];
+            vertices[c].Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+            vertices[c].Bitangent = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+        std::vector<Texture> textures = {{textureIds[i % TEXTURE_COUNT], "texture_diffuse", ""},
+                                         {textureIds[(i / TEXTURE_COUNT) % TEXTURE_COUNT], "texture_specular", ""}};
+        meshes.emplace_back(std::move(vertices), std::move(indices), std::move(textures));
+    }
+    return meshes;
+}
+
+int main(int argc, char **argv) {
+    size_t meshCount = argc > 1 ? (size_t)atoi(argv[1]) : 4096;
+    int frames = argc > 2 ? atoi(argv[2]) : 50;
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    GlfwTerminator glfwTerminator;
+
+    std::vector<unsigned int> textureIds(TEXTURE_COUNT);
+    glGenTextures(TEXTURE_COUNT, textureIds.data());
+    for (unsigned int i = 0; i < TEXTURE_COUNT; i++) {
+        unsigned char pixel[4] = {(unsigned char)(i * 16), 128, 255, 255};
+        glBindTexture(GL_TEXTURE_2D, textureIds[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    }
+    std::vector<Mesh> meshes = makeMeshes(meshCount, textureIds);
+
+    std::string defines = ShaderVariants::definesFor(SHADER_DIR_LIGHT);
+    Shader before("shaders/multilight.vs", "shaders/multilight.fs", defines);
+    Shader after("shaders/multilight.vs", "shaders/multilight.fs", defines);
+    SceneUniforms sceneUniforms(1);
+    sceneUniforms.upload();
+    sceneUniforms.bindView(0);
+    glEnable(GL_DEPTH_TEST);
+    printf("%zu meshes, %u textures, %d frames\n", meshCount, TEXTURE_COUNT, frames);
+
+    double beforeMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        before.use();
+        for (Mesh &mesh : meshes)
+            drawUncached(mesh, before);
+        beforeMs += timer.elapsedMs();
+        glFinish();
+    }
+
+    // the raw calls above went around GLState
+    GLState &state = GLState::shared();
+    state.invalidate();
+    double afterMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        after.use();
+        for (Mesh &mesh : meshes)
+            mesh.Draw(after);
+        afterMs += timer.elapsedMs();
+        glFinish();
+        state.endFrame();
+    }
+
+    size_t draws = meshCount * frames;
+    double beforeNs = beforeMs * 1e6 / draws, afterNs = afterMs * 1e6 / draws;
+    printf("%-28s %8.1f ns/draw %8.2f ms/frame\n", "strings per draw:", beforeNs, beforeMs / frames);
+    printf("%-28s %8.1f ns/draw %8.2f ms/frame %8.2fx\n", "cached bindings:", afterNs, afterMs / frames, beforeNs / afterNs);
+    state.printStats();
+
+    // every quad again, as instances of the first mesh
+    std::vector<glm::mat4> transforms;
+    for (size_t i = 0; i < meshCount; i++)
+        transforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3((float)(i % 64) / 32.0f, (float)(i / 64 % 64) / 32.0f, 0.0f)));
+    double uniformMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        after.use();
+        for (const glm::mat4 &transform : transforms) {
+            after.setmatrix4(shaderuniforms::multilight_vs::MODEL, transform);
+            meshes[0].Draw(after);
+        }
+        uniformMs += timer.elapsedMs();
+        glFinish();
+    }
+
+    Shader instanced("shaders/multilight.vs", "shaders/multilight.fs", ShaderVariants::definesFor(SHADER_DIR_LIGHT | SHADER_INSTANCED));
+    InstanceBuffer instances(transforms);
+    double instancedMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        instanced.use();
+        instances.bind();
+        meshes[0].DrawInstanced(instanced, instances.size());
+        instancedMs += timer.elapsedMs();
+        glFinish();
+    }
+    printf("%-28s %8.1f ns/instance %8.2f ms/frame\n", "model uniform per draw:", uniformMs * 1e6 / draws, uniformMs / frames);
+    printf("%-28s %8.1f ns/instance %8.2f ms/frame %8.2fx\n", "one instanced draw:", instancedMs * 1e6 / draws, instancedMs / frames, uniformMs / instancedMs);
+
+    meshes.clear();
+    glDeleteTextures(TEXTURE_COUNT, textureIds.data());
+    return 0;
+}
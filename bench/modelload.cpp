@@ -0,0 +1,84 @@
+// Model load benchmark: times each model cold (mesh cache removed) and warm (served from the cache),
+// then lists the vertex cache efficiency of every mesh before and after the optimization pass and what
+// welding plus 16 bit indices save against the plain import.
+// usage: modelload [model paths...], defaults to the assets used by framebuffer.cpp
+#include "bench.h"
+
+#include <model.h>
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+int main(int argc, char **argv) {
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+
+    stbi_set_flip_vertically_on_load(true);
+
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = {"res/tree/Tree.obj", "res/ground/ground.obj", "res/chair/chair.obj"};
+
+    std::vector<std::pair<std::string, std::vector<MeshOptStats>>> optimized;
+    printf("%-28s %8s %12s %12s %8s\n", "model", "meshes", "cold (ms)", "warm (ms)", "speedup");
+    for (const std::string &path : paths) {
+        std::remove(MeshCache::pathFor(path).c_str());
+
+        BenchTimer timer;
+        Model cold(path);
+        glFinish();
+        double coldMs = timer.elapsedMs();
+
+        timer.reset();
+        Model warm(path);
+        glFinish();
+        double warmMs = timer.elapsedMs();
+
+        if (!warm.loadedFromCache)
+            std::cout << "warning: " << path << " was not served from the mesh cache" << std::endl;
+        printf("%-28s %8zu %12.2f %12.2f %7.1fx\n", path.c_str(), warm.meshes.size(), coldMs, warmMs, coldMs / warmMs);
+        optimized.push_back({path, cold.optimizeStats});
+    }
+
+    // ACMR: vertex shader runs per triangle, ATVR: vertex shader runs per vertex, both for a 16 entry FIFO cache
+    printf("\n%-28s %6s %10s %10s %14s %14s\n", "model", "mesh", "vertices", "triangles", "ACMR", "ATVR");
+    for (const auto &model : optimized) {
+        for (size_t i = 0; i < model.second.size(); i++) {
+            const MeshOptStats &stats = model.second[i];
+            printf("%-28s %6zu %10u %10u %6.3f->%6.3f %6.3f->%6.3f\n", model.first.c_str(), i, stats.vertices, stats.triangles,
+                   stats.acmrBefore, stats.acmrAfter, stats.atvrBefore, stats.atvrAfter);
+        }
+    }
+
+    // plain import (no welding, 32 bit indices as before) against the default processing
+    printf("\n%-28s %10s %10s %12s %12s %14s %14s\n", "model", "vertices", "welded", "index KB", "16 bit KB", "VS runs", "VS runs after");
+    for (const std::string &path : paths) {
+        Model plain(path, false, 0);
+        Model processed(path);
+        size_t plainVertices = 0, plainIndexBytes = 0, plainRuns = 0;
+        for (const Mesh &mesh : plain.meshes) {
+            plainVertices += mesh.vertices.size();
+            plainIndexBytes += mesh.indices.size() * sizeof(unsigned int);
+            plainRuns += simulateVertexCache(mesh.indices, mesh.vertices.size());
+        }
+        size_t vertices = 0, indexBytes = 0, runs = 0;
+        for (const Mesh &mesh : processed.meshes) {
+            vertices += mesh.vertices.size();
+            indexBytes += mesh.indices.size() * (mesh.indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int));
+            runs += simulateVertexCache(mesh.indices, mesh.vertices.size());
+        }
+        printf("%-28s %10zu %10zu %12.1f %12.1f %14zu %14zu\n", path.c_str(), plainVertices, vertices,
+               plainIndexBytes / 1024.0, indexBytes / 1024.0, plainRuns, runs);
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Multi-draw benchmark: CPU time per frame of Model::Draw for the given models, loaded once with a buffer and a VAO
+// per mesh and one draw call per mesh, and once with MODEL_MULTI_DRAW (one MeshBuffer per model, one
+// glMultiDrawElementsIndirect per material). reports the draw calls, VAO and texture binds GLState let through in the last frame.
+// the time is the submission only, the GPU work is waited for outside of it.
+// usage: multidraw [frames] [model paths...], defaults 200 and the assets used by framebuffer.cpp.
+// run from the repository root so shaders/ can be found
+#include "bench.h"
+
+#include <glfwterminator.h>
+#include <glstate.h>
+#include <model.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+struct DrawResult {
+    double ms = 0.0;  // per frame
+    GLStateStats stats;
+};
+
+static DrawResult drawFrames(Model &model, ShaderVariants &variants, int frames) {
+    GLState &state = GLState::shared();
+    DrawResult result;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        model.Draw(variants, SHADER_DIR_LIGHT, glm::mat4(1.0f));
+        result.ms += timer.elapsedMs();
+        glFinish();
+        state.endFrame();
+    }
+    result.ms /= frames;
+    result.stats = state.lastFrameStats();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 200;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = {"res/tree/Tree.obj", "res/ground/ground.obj", "res/chair/chair.obj"};
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    GlfwTerminator glfwTerminator;
+
+    ShaderVariants variants("shaders/multilight_packed.vs", "shaders/multilight.fs");
+    SceneUniforms sceneUniforms(1);
+    sceneUniforms.upload();
+    sceneUniforms.bindView(0);
+    glEnable(GL_DEPTH_TEST);
+    printf("%d frames, packed vertices\n", frames);
+    printf("%-24s %7s %-12s %8s %6s %6s %9s\n", "model", "meshes", "path", "ms/frame", "draws", "VAOs", "textures");
+
+    const unsigned int flags = MODEL_DEFAULT_FLAGS | MODEL_PACKED_VERTICES;
+    for (const std::string &path : paths) {
+        Model perMesh(path, false, flags & ~MODEL_MULTI_DRAW);
+        Model multiDraw(path, false, flags);
+        // builds the variants outside of the timed frames
+        drawFrames(perMesh, variants, 1);
+        drawFrames(multiDraw, variants, 1);
+
+        DrawResult before = drawFrames(perMesh, variants, frames);
+        DrawResult after = drawFrames(multiDraw, variants, frames);
+        for (int i = 0; i < 2; i++) {
+            const DrawResult &result = i == 0 ? before : after;
+            printf("%-24s %7zu %-12s %8.3f %6u %6u %9u\n", i == 0 ? path.c_str() : "", perMesh.meshes.size(), i == 0 ? "per mesh" : "multi-draw", result.ms,
+                   result.stats.draws, result.stats.issued[GL_STATE_VERTEX_ARRAY], result.stats.issued[GL_STATE_TEXTURE]);
+        }
+    }
+
+    return 0;
+}
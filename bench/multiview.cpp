@@ -0,0 +1,189 @@
+// Multi-view benchmark: the same scene seen by several cameras, drawn into the layers of a LayeredFramebuffer once
+// per view (CommandList::replay for each layer) and in a single SHADER_MULTI_VIEW pass (CommandList::replayMultiView).
+// reports the CPU time per frame, the time until the GPU is done and the draw calls of the last frame, then compares
+// the layers of both, they should match.
+// usage: multiview [views] [meshes] [frames], defaults 4, 1024 and 50, at most MAX_MULTI_VIEWS views.
+// run from the repository root so shaders/ can be found
+#include "bench.h"
+
+#include <glfwterminator.h>
+#include <glstate.h>
+#include <instancebuffer.h>
+#include <layeredframebuffer.h>
+#include <mesh.h>
+#include <renderqueue.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <glm/gtc/matrix_transform.hpp>
+#include <vector>
+
+static const int TARGET_SIZE = 256;
+static const unsigned int TEXTURE_COUNT = 8;
+
+// a quad in the xy plane with a texture out of a small set
+static Mesh makeQuad(glm::vec3 corner, float size, unsigned int diffuse, unsigned int specular) {
+    std::vector<Vertex> vertices(4);
+    glm::vec2 corners[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+    for (int c = 0; c < 4; c++) {
+        vertices[c].Position = corner + glm::vec3(corners[c] * size, 0.0f);
+        vertices[c].Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+        vertices[c].TexCoords = corners[c];
+        vertices[c].Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+        vertices[c].Bitangent = glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+    std::vector<Texture> textures = {{diffuse, "texture_diffuse", ""}, {specular, "texture_specular", ""}};
+    return Mesh(std::move(vertices), std::move(indices), std::move(textures));
+}
+
+struct FrameResult {
+    double cpuMs = 0.0, gpuMs = 0.0;  // per frame, the second until glFinish returns
+    GLStateStats stats;
+};
+
+int main(int argc, char **argv) {
+    int views = argc > 1 ? atoi(argv[1]) : 4;
+    size_t meshCount = argc > 2 ? (size_t)atoi(argv[2]) : 1024;
+    int frames = argc > 3 ? atoi(argv[3]) : 50;
+    if (views < 1 || views > MAX_MULTI_VIEWS) {
+        fprintf(stderr, "views has to be between 1 and %d\n", MAX_MULTI_VIEWS);
+        return -1;
+    }
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    GlfwTerminator glfwTerminator;
+    bool multiView = LayeredFramebuffer::layerFromVertexShader();
+    printf("%d views of %dx%d, %zu meshes and an instanced one, %d frames\n", views, TARGET_SIZE, TARGET_SIZE, meshCount, frames);
+    if (!multiView)
+        printf("the vertex shader can't write gl_Layer here, only the per view pass runs\n");
+
+    std::vector<unsigned int> textureIds(TEXTURE_COUNT);
+    glGenTextures(TEXTURE_COUNT, textureIds.data());
+    for (unsigned int i = 0; i < TEXTURE_COUNT; i++) {
+        unsigned char pixel[4] = {(unsigned char)(i * 32), 160, (unsigned char)(255 - i * 32), 255};
+        glBindTexture(GL_TEXTURE_2D, textureIds[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    }
+    // a grid of quads at different depths, and one more quad drawn at a few places with instancing
+    std::vector<Mesh> meshes;
+    meshes.reserve(meshCount + 1);
+    for (size_t i = 0; i < meshCount; i++) {
+        float x = -2.0f + 4.0f * (float)(i % 32) / 32.0f, y = -1.0f + 2.0f * (float)(i / 32 % 32) / 32.0f;
+        float z = -(float)(i * 7919 % meshCount) / (float)meshCount;
+        meshes.push_back(makeQuad(glm::vec3(x, y, z), 3.0f / 32.0f, textureIds[i % TEXTURE_COUNT], textureIds[i * 3 % TEXTURE_COUNT]));
+    }
+    meshes.push_back(makeQuad(glm::vec3(-0.5f, -0.5f, 0.0f), 1.0f, textureIds[1], textureIds[2]));
+    std::vector<glm::mat4> instanceTransforms;
+    for (int i = 0; i < 4; i++)
+        instanceTransforms.push_back(glm::translate(glm::mat4(1.0f), glm::vec3(-1.5f + (float)i, 0.0f, 0.5f)));
+    InstanceBuffer instances(instanceTransforms);
+
+    // the cameras stand on an arc in front of the scene
+    SceneUniforms sceneUniforms(views);
+    sceneUniforms.lighting.shininess = 32.0f;
+    sceneUniforms.lighting.dirLight = {glm::vec3(-0.2f, -0.5f, -1.0f), 0.0f, glm::vec3(0.2f), 0.0f, glm::vec3(0.8f), 0.0f, glm::vec3(0.3f), 0.0f};
+    for (int view = 0; view < views; view++) {
+        float angle = glm::radians(-40.0f + 80.0f * (float)view / (float)std::max(views - 1, 1));
+        glm::vec3 position(4.0f * glm::sin(angle), 0.5f, 4.0f * glm::cos(angle));
+        sceneUniforms.views[view] = {glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f), glm::lookAt(position, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+                                     position, 0.0f};
+    }
+    sceneUniforms.upload();
+
+    ShaderVariants variants("shaders/multilight.vs", "shaders/multilight.fs");
+    LayeredFramebuffer targets(TARGET_SIZE, TARGET_SIZE, views);
+    GLState &state = GLState::shared();
+    glViewport(0, 0, TARGET_SIZE, TARGET_SIZE);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glEnable(GL_DEPTH_TEST);
+    state.invalidate();
+
+    RenderQueue queue;
+    CommandList commands;
+    // the scene is recorded with the variant the pass needs, the recording isn't timed
+    auto record = [&](unsigned int variant) {
+        Shader *shader = variants.get(variant), *instanced = variants.get(variant | SHADER_INSTANCED);
+        queue.begin(sceneUniforms.views[0].viewPos);
+        unsigned int transform = queue.addTransform(glm::mat4(1.0f));
+        for (size_t i = 0; i < meshCount; i++) {
+            RenderCommand command;
+            command.shader = shader;
+            command.mesh = &meshes[i];
+            command.transform = transform;
+            command.center = meshes[i].bounds.offset;
+            queue.submit(command);
+        }
+        RenderCommand command;
+        command.shader = instanced;
+        command.mesh = &meshes.back();
+        command.instances = &instances;
+        queue.submit(command);
+        queue.record(commands);
+    };
+    auto run = [&](bool singlePass) {
+        FrameResult result;
+        for (int frame = 0; frame < frames; frame++) {
+            BenchTimer timer;
+            if (singlePass) {
+                state.bindFramebuffer(targets.framebuffer());
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                commands.replayMultiView(sceneUniforms);
+            } else {
+                for (int layer = 0; layer < views; layer++) {
+                    state.bindFramebuffer(targets.layerFramebuffer(layer));
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    commands.replay(sceneUniforms, layer);
+                }
+            }
+            result.cpuMs += timer.elapsedMs();
+            glFinish();
+            result.gpuMs += timer.elapsedMs();
+            state.endFrame();
+        }
+        result.cpuMs /= frames;
+        result.gpuMs /= frames;
+        result.stats = state.lastFrameStats();
+        return result;
+    };
+    auto readLayers = [&]() {
+        std::vector<unsigned char> pixels((size_t)TARGET_SIZE * TARGET_SIZE * 3 * views);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTextureImage(targets.colorTexture(), 0, GL_RGB, GL_UNSIGNED_BYTE, (GLsizei)pixels.size(), pixels.data());
+        return pixels;
+    };
+
+    printf("%-12s %9s %9s %6s %9s\n", "path", "cpu ms", "frame ms", "draws", "programs");
+    record(SHADER_DIR_LIGHT);
+    run(false);
+    FrameResult perView = run(false);
+    std::vector<unsigned char> perViewPixels = readLayers();
+    printf("%-12s %9.3f %9.3f %6u %9u\n", "per view", perView.cpuMs, perView.gpuMs, perView.stats.draws, perView.stats.issued[GL_STATE_PROGRAM]);
+    if (multiView) {
+        record(SHADER_DIR_LIGHT | SHADER_MULTI_VIEW);
+        run(true);
+        FrameResult singlePass = run(true);
+        std::vector<unsigned char> singlePassPixels = readLayers();
+        printf("%-12s %9.3f %9.3f %6u %9u\n", "multi-view", singlePass.cpuMs, singlePass.gpuMs, singlePass.stats.draws, singlePass.stats.issued[GL_STATE_PROGRAM]);
+
+        size_t layerBytes = (size_t)TARGET_SIZE * TARGET_SIZE * 3;
+        for (int layer = 0; layer < views; layer++) {
+            int maxDiff = 0;
+            size_t lit = 0;
+            for (size_t i = layer * layerBytes; i < (layer + 1) * layerBytes; i++) {
+                maxDiff = std::max(maxDiff, std::abs((int)perViewPixels[i] - (int)singlePassPixels[i]));
+                lit += perViewPixels[i] != 0;
+            }
+            printf("layer %d: max channel difference %d, %zu non-zero channels\n", layer, maxDiff, lit);
+        }
+    }
+
+    meshes.clear();
+    glDeleteTextures(TEXTURE_COUNT, textureIds.data());
+    return 0;
+}
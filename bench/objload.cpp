@@ -0,0 +1,155 @@
+// OBJ load benchmark: compares the native ObjLoader with the ASSIMP importer, both for the raw parse and for a
+// complete Model load, and checks that both produce the same meshes.
+// usage: objload [obj paths...], defaults to the assets used by framebuffer.cpp
+//        objload --generate <megabytes> <path.obj>   writes a synthetic OBJ/MTL pair of about that size
+#include "bench.h"
+
+#include <model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// a few tiled, wavy grids with quads, every grid its own object and material
+static void generateObj(double megabytes, const std::string &path) {
+    std::string stem = path.substr(0, path.find_last_of('.'));
+    std::string mtlName = stem.substr(stem.find_last_of('/') + 1) + ".mtl";
+    std::ofstream mtl(stem + ".mtl");
+    std::ofstream obj(path);
+    obj << "mtllib " << mtlName << "\n";
+    const int objects = 4;
+    // a grid cell costs roughly 90 bytes: its v, vt, vn lines plus one quad
+    int side = std::max(2, (int)std::sqrt(megabytes * 1024.0 * 1024.0 / objects / 90.0));
+    char line[256];
+    size_t base = 1;
+    for (int o = 0; o < objects; o++) {
+        mtl << "newmtl grid" << o << "\nmap_Kd grid" << o << "_diffuse.png\nmap_Bump -bm 1.0 grid" << o << "_normal.png\n\n";
+        obj << "o grid" << o << "\nusemtl grid" << o << "\n";
+        for (int y = 0; y < side; y++) {
+            for (int x = 0; x < side; x++) {
+                float u = (float)x / (side - 1), v = (float)y / (side - 1);
+                float height = 0.1f * std::sin(u * 20.0f + o) * std::cos(v * 20.0f);
+                glm::vec3 normal = glm::normalize(glm::vec3(-2.0f * std::cos(u * 20.0f + o) * std::cos(v * 20.0f), 1.0f, 2.0f * std::sin(u * 20.0f + o) * std::sin(v * 20.0f)));
+                obj.write(line, snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn %.6f %.6f %.6f\n", u * 10.0f + o * 11.0f, height, v * 10.0f, u, v, normal.x, normal.y, normal.z));
+            }
+        }
+        for (int y = 0; y + 1 < side; y++) {
+            for (int x = 0; x + 1 < side; x++) {
+                size_t a = base + y * side + x, b = a + 1, c = a + side + 1, d = a + side;
+                obj.write(line, snprintf(line, sizeof(line), "f %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu %zu/%zu/%zu\n", a, a, a, b, b, b, c, c, c, d, d, d));
+            }
+        }
+        base += (size_t)side * side;
+    }
+    printf("wrote %s (%d objects, %d x %d vertices each)\n", path.c_str(), objects, side, side);
+}
+
+// largest difference between corresponding corners, only meaningful when the triangle counts match
+static float maxDifference(const Model &a, const Model &b, glm::vec3 Vertex::*attribute) {
+    float difference = 0.0f;
+    for (size_t m = 0; m < std::min(a.meshes.size(), b.meshes.size()); m++) {
+        const Mesh &meshA = a.meshes[m], &meshB = b.meshes[m];
+        if (meshA.indices.size() != meshB.indices.size())
+            continue;
+        for (size_t i = 0; i < meshA.indices.size(); i++) {
+            glm::vec3 delta = meshA.vertices[meshA.indices[i]].*attribute - meshB.vertices[meshB.indices[i]].*attribute;
+            difference = std::max(difference, std::max(std::abs(delta.x), std::max(std::abs(delta.y), std::abs(delta.z))));
+        }
+    }
+    return difference;
+}
+
+static float maxTexCoordDifference(const Model &a, const Model &b) {
+    float difference = 0.0f;
+    for (size_t m = 0; m < std::min(a.meshes.size(), b.meshes.size()); m++) {
+        const Mesh &meshA = a.meshes[m], &meshB = b.meshes[m];
+        if (meshA.indices.size() != meshB.indices.size())
+            continue;
+        for (size_t i = 0; i < meshA.indices.size(); i++) {
+            glm::vec2 delta = meshA.vertices[meshA.indices[i]].TexCoords - meshB.vertices[meshB.indices[i]].TexCoords;
+            difference = std::max(difference, std::max(std::abs(delta.x), std::abs(delta.y)));
+        }
+    }
+    return difference;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 4 && std::strcmp(argv[1], "--generate") == 0) {
+        generateObj(std::atof(argv[2]), argv[3]);
+        return 0;
+    }
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = {"res/tree/Tree.obj", "res/ground/ground.obj", "res/chair/chair.obj"};
+
+    printf("%-28s %9s %12s %12s %8s %13s %13s\n", "model", "MB", "assimp (ms)", "native (ms)", "speedup", "assimp model", "native model");
+    for (const std::string &path : paths) {
+        MappedFile file(path);
+        double megabytes = file.size() / (1024.0 * 1024.0);
+        file.close();
+
+        BenchTimer timer;
+        {
+            Assimp::Importer importer;
+            importer.ReadFile(path, MODEL_IMPORT_FLAGS);
+        }
+        double assimpMs = timer.elapsedMs();
+
+        timer.reset();
+        {
+            std::vector<MeshData> meshes;
+            ObjLoader::load(path, meshes);
+        }
+        double nativeMs = timer.elapsedMs();
+
+        // whole loads without the mesh cache and the other processing, the importer is the only difference
+        timer.reset();
+        Model assimp(path, false, MODEL_WELD);
+        glFinish();
+        double assimpModelMs = timer.elapsedMs();
+
+        timer.reset();
+        Model native(path, false, MODEL_WELD | MODEL_NATIVE_OBJ);
+        glFinish();
+        double nativeModelMs = timer.elapsedMs();
+
+        printf("%-28s %9.1f %12.1f %12.1f %7.1fx %10.1f ms %10.1f ms\n", path.c_str(), megabytes, assimpMs, nativeMs, assimpMs / nativeMs, assimpModelMs, nativeModelMs);
+
+        // both welded, so the vertex counts are comparable even though ASSIMP emits a vertex per face corner
+        size_t assimpTriangles = 0, nativeTriangles = 0, assimpVertices = 0, nativeVertices = 0;
+        bool texturesMatch = assimp.meshes.size() == native.meshes.size();
+        for (const Mesh &mesh : assimp.meshes) {
+            assimpTriangles += mesh.indexCount / 3;
+            assimpVertices += mesh.vertexCount;
+        }
+        for (size_t m = 0; m < native.meshes.size(); m++) {
+            nativeTriangles += native.meshes[m].indexCount / 3;
+            nativeVertices += native.meshes[m].vertexCount;
+            if (texturesMatch) {
+                const vector<Texture> &a = assimp.meshes[m].textures, &b = native.meshes[m].textures;
+                texturesMatch = a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const Texture &x, const Texture &y) { return x.type == y.type && x.path == y.path; });
+            }
+        }
+        printf("    meshes %zu / %zu, triangles %zu / %zu, vertices %zu / %zu, textures %s\n", assimp.meshes.size(), native.meshes.size(),
+               assimpTriangles, nativeTriangles, assimpVertices, nativeVertices, texturesMatch ? "match" : "differ");
+        printf("    max difference: position %g, normal %g, texcoords %g, tangent %g\n", maxDifference(assimp, native, &Vertex::Position),
+               maxDifference(assimp, native, &Vertex::Normal), maxTexCoordDifference(assimp, native), maxDifference(assimp, native, &Vertex::Tangent));
+    }
+
+    glfwTerminate();
+    return 0;
+}
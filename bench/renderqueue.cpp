@@ -0,0 +1,171 @@
+// Render queue benchmark: thousands of small meshes with mixed programs and textures, submitted in a scattered
+// order. drawn immediately in that order (Mesh::Draw per mesh) against queued and sorted (RenderQueue::execute).
+// reports the CPU time per frame, including the sort for the queue, and the state calls GLState let through.
+// then the same scene for several views, queued and sorted for each against recorded once into a CommandList and
+// replayed per view.
+// usage: renderqueue [meshes] [frames] [views], defaults 4096, 50 and 4. run from the repository root so shaders/ can be found
+#include "bench.h"
+
+#include <glfwterminator.h>
+#include <glstate.h>
+#include <mesh.h>
+#include <renderqueue.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const unsigned int TEXTURE_COUNT = 16;
+
+// one quad per mesh, spread over a grid at increasing depth, with textures out of a small set
+static std::vector<Mesh> makeMeshes(size_t count, const std::vector<unsigned int> &textureIds) {
+    std::vector<Mesh> meshes;
+    meshes.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        float x = -1.0f + 2.0f * (float)(i % 64) / 64.0f, y = -1.0f + 2.0f * (float)(i / 64 % 64) / 64.0f, size = 2.0f / 64.0f;
+        float z = -(float)(i * 7919 % count) / (float)count;
+        std::vector<Vertex> vertices(4);
+        glm::vec2 corners[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+        for (int c = 0; c < 4; c++) {
+            vertices[c].Position = glm::vec3(x + corners[c].x * size, y + corners[c].y * size, z);
+            vertices[c].Normal = glm::vec3(0.0f, 0.0f, 1.0f);
+            vertices[c].TexCoords = corners[c];
+            vertices[c].Tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+            vertices[c].Bitangent = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+        std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+        std::vector<Texture> textures = {{textureIds[i * 5 % TEXTURE_COUNT], "texture_diffuse", ""},
+                                         {textureIds[i * 3 % TEXTURE_COUNT], "texture_specular", ""}};
+        meshes.emplace_back(std::move(vertices), std::move(indices), std::move(textures));
+    }
+    return meshes;
+}
+
+static void printResult(const char *name, double ms, int frames, const GLStateStats &stats) {
+    printf("%-22s %8.3f ms/frame %6u draws %6u programs %6u textures %6u VAOs\n", name, ms / frames, stats.draws, stats.issued[GL_STATE_PROGRAM],
+           stats.issued[GL_STATE_TEXTURE], stats.issued[GL_STATE_VERTEX_ARRAY]);
+}
+
+int main(int argc, char **argv) {
+    size_t meshCount = argc > 1 ? (size_t)atoi(argv[1]) : 4096;
+    int frames = argc > 2 ? atoi(argv[2]) : 50;
+    size_t views = argc > 3 ? (size_t)atoi(argv[3]) : 4;
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    GlfwTerminator glfwTerminator;
+
+    std::vector<unsigned int> textureIds(TEXTURE_COUNT);
+    glGenTextures(TEXTURE_COUNT, textureIds.data());
+    for (unsigned int i = 0; i < TEXTURE_COUNT; i++) {
+        unsigned char pixel[4] = {(unsigned char)(i * 16), 128, 255, 255};
+        glBindTexture(GL_TEXTURE_2D, textureIds[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    }
+    std::vector<Mesh> meshes = makeMeshes(meshCount, textureIds);
+
+    // every other mesh gets the spotlight variant, so the immediate order keeps switching programs
+    ShaderVariants variants("shaders/multilight.vs", "shaders/multilight.fs");
+    Shader *programs[2] = {variants.get(SHADER_DIR_LIGHT), variants.get(SHADER_DIR_LIGHT | SHADER_SPOT_LIGHT)};
+    SceneUniforms sceneUniforms(views);
+    sceneUniforms.upload();
+    sceneUniforms.bindView(0);
+    glEnable(GL_DEPTH_TEST);
+    GLState &state = GLState::shared();
+    state.invalidate();
+    printf("%zu meshes, %u textures, 2 programs, %d frames\n", meshCount, TEXTURE_COUNT, frames);
+
+    glm::mat4 model(1.0f);
+    double immediateMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            Shader *shader = programs[i % 2];
+            shader->use();
+            shader->setmatrix4(shaderuniforms::multilight_vs::MODEL, model);
+            meshes[i].Draw(*shader);
+        }
+        immediateMs += timer.elapsedMs();
+        glFinish();
+        state.endFrame();
+    }
+    printResult("immediate:", immediateMs, frames, state.lastFrameStats());
+
+    RenderQueue queue;
+    double queuedMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        BenchTimer timer;
+        queue.begin(glm::vec3(0.0f, 0.0f, 3.0f));
+        unsigned int transform = queue.addTransform(model);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            RenderCommand command;
+            command.shader = programs[i % 2];
+            command.mesh = &meshes[i];
+            command.transform = transform;
+            command.center = meshes[i].bounds.offset;
+            queue.submit(command);
+        }
+        queue.execute();
+        queuedMs += timer.elapsedMs();
+        glFinish();
+        state.endFrame();
+    }
+    printResult("queued and sorted:", queuedMs, frames, state.lastFrameStats());
+
+    // the views only differ in their view block
+    printf("%zu views\n", views);
+    double perViewMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        BenchTimer timer;
+        for (size_t view = 0; view < views; view++) {
+            sceneUniforms.bindView(view);
+            queue.begin(sceneUniforms.views[view].viewPos);
+            unsigned int transform = queue.addTransform(model);
+            for (size_t i = 0; i < meshes.size(); i++) {
+                RenderCommand command;
+                command.shader = programs[i % 2];
+                command.mesh = &meshes[i];
+                command.transform = transform;
+                command.center = meshes[i].bounds.offset;
+                queue.submit(command);
+            }
+            queue.execute();
+        }
+        perViewMs += timer.elapsedMs();
+        glFinish();
+        state.endFrame();
+    }
+    printResult("queued per view:", perViewMs, frames, state.lastFrameStats());
+
+    CommandList commands;
+    double replayedMs = 0.0;
+    for (int frame = 0; frame < frames; frame++) {
+        BenchTimer timer;
+        queue.begin(sceneUniforms.views[0].viewPos);
+        unsigned int transform = queue.addTransform(model);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            RenderCommand command;
+            command.shader = programs[i % 2];
+            command.mesh = &meshes[i];
+            command.transform = transform;
+            command.center = meshes[i].bounds.offset;
+            queue.submit(command);
+        }
+        queue.record(commands);
+        for (size_t view = 0; view < views; view++)
+            commands.replay(sceneUniforms, view);
+        replayedMs += timer.elapsedMs();
+        glFinish();
+        state.endFrame();
+    }
+    printResult("recorded and replayed:", replayedMs, frames, state.lastFrameStats());
+
+    meshes.clear();
+    glDeleteTextures(TEXTURE_COUNT, textureIds.data());
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Scene memory benchmark: loads a set of models the way framebuffer.cpp does and reports the resident
+// memory before loading, the peak while loading and what stays resident afterwards. The peak is per process,
+// so compare modes with separate runs.
+// usage: scenememory [--gpu-only] [--no-cache] [model paths...], defaults to the assets used by framebuffer.cpp
+#include "bench.h"
+
+#include <model.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+static double toMB(double bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+int main(int argc, char **argv) {
+    unsigned int flags = MODEL_DEFAULT_FLAGS;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--gpu-only") == 0)
+            flags |= MODEL_GPU_ONLY;
+        else if (std::strcmp(argv[i], "--no-cache") == 0)
+            flags &= ~MODEL_USE_CACHE;
+        else
+            paths.push_back(argv[i]);
+    }
+    if (paths.empty())
+        paths = {"res/tree/Tree.obj", "res/ground/ground.obj", "res/chair/chair.obj"};
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    stbi_set_flip_vertically_on_load(true);
+
+    {
+        glFinish();
+        bool peakReset = resetPeakMemory();
+        MemoryUsage before = memoryUsage();
+
+        BenchTimer timer;
+        std::vector<Model> models;
+        models.reserve(paths.size());
+        for (const std::string &path : paths)
+            models.emplace_back(path, false, flags);
+        glFinish();
+        double loadMs = timer.elapsedMs();
+        MemoryUsage loaded = memoryUsage();
+
+        size_t vertices = 0, cpuBytes = 0;
+        for (const Model &model : models) {
+            for (const Mesh &mesh : model.meshes) {
+                vertices += mesh.vertexCount;
+                cpuBytes += mesh.vertices.capacity() * sizeof(Vertex) + mesh.indices.capacity() * sizeof(unsigned int);
+            }
+        }
+
+        printf("mode:            %s%s\n", flags & MODEL_GPU_ONLY ? "gpu only" : "keep cpu copies", flags & MODEL_USE_CACHE ? "" : ", no mesh cache");
+        printf("models:          %zu (%zu vertices) in %.1f ms\n", models.size(), vertices, loadMs);
+        printf("mesh CPU copies: %.2f MB\n", toMB(cpuBytes));
+        printf("RSS before:      %.2f MB\n", toMB(before.current));
+        printf("RSS peak:        %.2f MB%s\n", toMB(loaded.peak), peakReset ? "" : " (since process start)");
+        printf("RSS steady:      %.2f MB (+%.2f MB)\n", toMB(loaded.current), toMB((double)loaded.current - (double)before.current));
+    }
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Shader reload benchmark: frame times while the multilight variants (include/shadervariants.h) build at startup and
+// while they rebuild after their fragment shader is saved, with the ShaderLibrary building synchronously in the frame
+// that asks for a program and asynchronously (include/shaderlibrary.h). the program binary cache is off so every
+// build compiles. the shaders are copied to a temporary directory that gets watched and edited.
+// usage: shaderreload [variants], default 16. run from the repository root so shaders/ can be found
+#include "bench.h"
+
+#include <shader.h>
+#include <shaderlibrary.h>
+#include <shadervariants.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const double TIMEOUT_MS = 30000.0;
+
+struct FrameStats {
+    std::vector<double> frames;
+
+    void add(double ms) {
+        frames.push_back(ms);
+    }
+
+    void print(const char *label) const {
+        std::vector<double> sorted = frames;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0.0;
+        for (double ms : frames)
+            total += ms;
+        double median = sorted.empty() ? 0.0 : sorted[sorted.size() / 2];
+        double worst = sorted.empty() ? 0.0 : sorted.back();
+        printf("%-14s %6zu frames %10.2f ms total %8.2f ms median %8.2f ms worst\n", label, frames.size(), total, median, worst);
+    }
+};
+
+// distinct combinations of the variant bits, the four feature bits are consecutive from SHADER_DIR_LIGHT
+static std::vector<unsigned int> someVariants(size_t count) {
+    std::vector<unsigned int> variants;
+    for (unsigned int flags = 0; flags < 16; flags++) {
+        for (int pointLights = 0; pointLights <= MAX_POINT_LIGHTS; pointLights++)
+            variants.push_back(shaderPointLights(pointLights) | flags * SHADER_DIR_LIGHT);
+    }
+    variants.resize(std::min(variants.size(), count));
+    return variants;
+}
+
+// one frame of the benchmark: look every variant up like Model::Draw does and draw nothing with it
+static size_t frame(ShaderLibrary &library, ShaderVariants &variants, const std::vector<unsigned int> &wanted, size_t &swapped) {
+    swapped += library.update();
+    size_t usable = 0;
+    for (unsigned int variant : wanted) {
+        if (Shader *shader = variants.get(variant)) {
+            shader->use();
+            usable++;
+        }
+    }
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glFinish();
+    return usable;
+}
+
+static void run(ShaderBuild mode, const std::filesystem::path &directory, const std::vector<unsigned int> &wanted) {
+    const char *label = mode == SHADER_BUILD_NOW ? "sync" : "async";
+    ShaderLibrary library(mode);
+    library.watch(directory.string());
+    ShaderVariants variants(library, (directory / "multilight.vs").string(), (directory / "multilight.fs").string());
+
+    // startup: until every variant can draw
+    FrameStats startup;
+    size_t swapped = 0;
+    BenchTimer total;
+    for (size_t usable = 0; usable < wanted.size() && total.elapsedMs() < TIMEOUT_MS;) {
+        BenchTimer timer;
+        usable = frame(library, variants, wanted, swapped);
+        startup.add(timer.elapsedMs());
+    }
+
+    // edit: until every variant has been swapped for its rebuild
+    std::ofstream((directory / "multilight.fs").string(), std::ios::app) << "\n// edited\n";
+    FrameStats edit;
+    swapped = 0;
+    total.reset();
+    while (swapped < wanted.size() && total.elapsedMs() < TIMEOUT_MS) {
+        BenchTimer timer;
+        frame(library, variants, wanted, swapped);
+        edit.add(timer.elapsedMs());
+    }
+
+    printf("%s\n", label);
+    startup.print("  startup");
+    edit.print("  after edit");
+}
+
+int main(int argc, char **argv) {
+    std::vector<unsigned int> wanted = someVariants(argc > 1 ? (size_t)atoi(argv[1]) : 16);
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    ShaderCache::enabled() = false;
+    printf("parallel shader compile: %s\n", Shader::parallelCompileSupported() ? "yes" : "no");
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "shaderreload";
+    for (ShaderBuild mode : {SHADER_BUILD_NOW, SHADER_BUILD_ASYNC}) {
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+        std::filesystem::create_directories(directory);
+        std::filesystem::copy_file("shaders/multilight.vs", directory / "multilight.vs");
+        std::filesystem::copy_file("shaders/multilight.fs", directory / "multilight.fs");
+        run(mode, directory, wanted);
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    glfwTerminate();
+    return 0;
+}
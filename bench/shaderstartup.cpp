@@ -0,0 +1,70 @@
+// Shader startup benchmark: builds the multilight variants (include/shadervariants.h) for both vertex formats, first with
+// an empty program binary cache (compile, link and store) and then again from shadercache/ (glProgramBinary only).
+// usage: shaderstartup [variants per vertex shader], default all of them. run from the repository root so shaders/ can be found.
+// the driver may keep its own shader cache that speeds up the cold run (Mesa only exposes binary formats while it is on)
+#include "bench.h"
+
+#include <shader.h>
+#include <shadervariants.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static const char *const VERTEX_SHADERS[] = {"shaders/multilight.vs", "shaders/multilight_packed.vs"};
+
+// every valid combination of the variant bits
+static std::vector<unsigned int> allVariants() {
+    std::vector<unsigned int> variants;
+    // the four feature bits are consecutive, starting at SHADER_DIR_LIGHT
+    for (unsigned int flags = 0; flags < 16; flags++) {
+        for (int pointLights = 0; pointLights <= MAX_POINT_LIGHTS; pointLights++)
+            variants.push_back(shaderPointLights(pointLights) | flags * SHADER_DIR_LIGHT);
+    }
+    return variants;
+}
+
+// builds the variants, returns the time in ms including a glFinish
+static double buildAll(const std::vector<unsigned int> &variants, size_t &fromCache, size_t &programs) {
+    BenchTimer timer;
+    fromCache = 0;
+    programs = 0;
+    for (const char *vertexShader : VERTEX_SHADERS) {
+        ShaderVariants shaders(vertexShader, "shaders/multilight.fs");
+        for (unsigned int variant : variants)
+            fromCache += shaders.get(variant)->loadedFromCache ? 1 : 0;
+        programs += shaders.size();
+    }
+    glFinish();
+    return timer.elapsedMs();
+}
+
+int main(int argc, char **argv) {
+    std::vector<unsigned int> variants = allVariants();
+    if (argc > 1)
+        variants.resize(std::min(variants.size(), (size_t)atoi(argv[1])));
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    if (!ShaderCache::supported())
+        printf("WARNING::BENCH::driver exposes no program binary formats, both runs compile\n");
+
+    // cold start: nothing cached yet
+    std::error_code error;
+    std::filesystem::remove_all(ShaderCache::directory(), error);
+    size_t coldHits, warmHits, programs;
+    double coldMs = buildAll(variants, coldHits, programs);
+    double warmMs = buildAll(variants, warmHits, programs);
+
+    printf("%zu programs\n", programs);
+    printf("cold: %10.2f ms (%zu from cache)\n", coldMs, coldHits);
+    printf("warm: %10.2f ms (%zu from cache)\n", warmMs, warmHits);
+    printf("speedup: %7.2fx\n", coldMs / warmMs);
+
+    glfwTerminate();
+    return 0;
+}
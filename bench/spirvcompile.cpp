@@ -0,0 +1,81 @@
+// SPIR-V benchmark: driver time to build the multilight variants (include/shadervariants.h) from GLSL text and from
+// the SPIR-V modules of tools/spirvcompile, where glSpecializeShader replaces the GLSL front end. the program binary
+// cache is off so both sides compile, each program is drawn once so lazily compiling drivers do their work too.
+// usage: spirvcompile [variants per vertex shader], default all of them. run from the repository root after
+// tools/spirvcompile so shaders/ and shaders/spirv/ can be found
+#include "bench.h"
+
+#include <shader.h>
+#include <shadervariants.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static const char *const VERTEX_SHADERS[] = {"shaders/multilight.vs", "shaders/multilight_packed.vs"};
+
+// every valid combination of the variant bits
+static std::vector<unsigned int> allVariants() {
+    std::vector<unsigned int> variants;
+    // the four feature bits are consecutive, starting at SHADER_DIR_LIGHT
+    for (unsigned int flags = 0; flags < 16; flags++) {
+        for (int pointLights = 0; pointLights <= MAX_POINT_LIGHTS; pointLights++)
+            variants.push_back(shaderPointLights(pointLights) | flags * SHADER_DIR_LIGHT);
+    }
+    return variants;
+}
+
+// builds the variants and draws a point with each, returns the time in ms including a glFinish
+static double buildAll(ShaderLanguage language, const std::vector<unsigned int> &variants, size_t &linked) {
+    unsigned int vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    BenchTimer timer;
+    linked = 0;
+    for (const char *vertexShader : VERTEX_SHADERS) {
+        ShaderVariants shaders(vertexShader, "shaders/multilight.fs", language);
+        for (unsigned int variant : variants) {
+            Shader *shader = shaders.get(variant);
+            if (!shader->linked)
+                continue;
+            linked++;
+            shader->use();
+            glDrawArrays(GL_POINTS, 0, 1);
+        }
+    }
+    glFinish();
+    double ms = timer.elapsedMs();
+    glDeleteVertexArrays(1, &vao);
+    return ms;
+}
+
+int main(int argc, char **argv) {
+    std::vector<unsigned int> variants = allVariants();
+    if (argc > 1)
+        variants.resize(std::min(variants.size(), (size_t)atoi(argv[1])));
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    ShaderCache::enabled() = false;
+
+    size_t linked;
+    double glslMs = buildAll(SHADER_GLSL, variants, linked);
+    printf("glsl:  %10.2f ms, %zu programs linked, %8.3f ms/program\n", glslMs, linked, glslMs / std::max(linked, (size_t)1));
+
+    bool modules = true;
+    for (const char *vertexShader : VERTEX_SHADERS)
+        modules = modules && ShaderVariants::spirvAvailable(vertexShader, "shaders/multilight.fs");
+    if (!modules) {
+        printf("WARNING::BENCH::no SPIR-V modules in shaders/spirv, run tools/spirvcompile first\n");
+        glfwTerminate();
+        return 0;
+    }
+    double spirvMs = buildAll(SHADER_SPIRV, variants, linked);
+    printf("spirv: %10.2f ms, %zu programs linked, %8.3f ms/program\n", spirvMs, linked, spirvMs / std::max(linked, (size_t)1));
+    printf("speedup: %7.2fx\n", glslMs / spirvMs);
+
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,98 @@
+// Texture load benchmark: synchronous TextureFromFile vs. AsyncTextureLoader (background decode + PBO uploads).
+// usage: textureload [image files...], without arguments 128 synthetic 512x512 TGA images are generated.
+// Pass real PNGs for representative numbers, TGA decoding is much cheaper than inflating a PNG.
+#include "bench.h"
+
+#include <model.h>
+#include <textureloader.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+// writes an uncompressed 32-bit TGA with a per-image pattern
+static void writeTestImage(const std::string &path, int size, int seed) {
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+        return;
+    unsigned char header[18] = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                (unsigned char)(size & 0xff), (unsigned char)(size >> 8), (unsigned char)(size & 0xff), (unsigned char)(size >> 8), 32, 8};
+    fwrite(header, 1, sizeof(header), file);
+    std::vector<unsigned char> pixels((size_t)size * size * 4);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            unsigned char *p = &pixels[((size_t)y * size + x) * 4];
+            p[0] = (unsigned char)(x * seed);
+            p[1] = (unsigned char)(y + seed);
+            p[2] = (unsigned char)((x ^ y) + seed * 7);
+            p[3] = 255;
+        }
+    }
+    fwrite(pixels.data(), 1, pixels.size(), file);
+    fclose(file);
+}
+
+int main(int argc, char **argv) {
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++)
+        files.push_back(argv[i]);
+    if (files.empty()) {
+        std::filesystem::path dir = std::filesystem::temp_directory_path() / "textureload_bench";
+        std::filesystem::create_directories(dir);
+        for (int i = 0; i < 128; i++) {
+            std::string path = (dir / ("image" + std::to_string(i) + ".tga")).generic_string();
+            if (!std::filesystem::exists(path))
+                writeTestImage(path, 512, i + 1);
+            files.push_back(path);
+        }
+    }
+    printf("%zu textures\n", files.size());
+
+    // warm the OS file cache so both runs read from memory
+    for (const std::string &file : files) {
+        MappedFile mapped(file);
+        volatile unsigned char sink = mapped.isOpen() ? mapped.data()[mapped.size() - 1] : 0;
+        (void)sink;
+    }
+
+    // both loaders take a path relative to a directory
+    std::vector<std::string> names, directories;
+    for (const std::string &file : files) {
+        std::filesystem::path path(file);
+        names.push_back(path.filename().generic_string());
+        directories.push_back(path.has_parent_path() ? path.parent_path().generic_string() : ".");
+    }
+
+    std::vector<unsigned int> ids;
+    BenchTimer timer;
+    for (size_t i = 0; i < files.size(); i++)
+        ids.push_back(TextureFromFile(names[i].c_str(), directories[i]));
+    glFinish();
+    double syncMs = timer.elapsedMs();
+    glDeleteTextures((GLsizei)ids.size(), ids.data());
+    ids.clear();
+
+    AsyncTextureLoader loader;
+    timer.reset();
+    for (size_t i = 0; i < files.size(); i++)
+        ids.push_back(loader.request(names[i], directories[i]));
+    double requestMs = timer.elapsedMs();
+    loader.finish();
+    glFinish();
+    double asyncMs = timer.elapsedMs();
+    glDeleteTextures((GLsizei)ids.size(), ids.data());
+
+    printf("synchronous: %10.2f ms\n", syncMs);
+    printf("async:       %10.2f ms (all placeholders bindable after %.2f ms)\n", asyncMs, requestMs);
+    printf("speedup:     %10.2fx\n", syncMs / asyncMs);
+
+    glfwTerminate();
+    return 0;
+}
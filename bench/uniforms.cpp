@@ -0,0 +1,138 @@
+// Uniform benchmark: per call cost of setting uniforms by name through glGetUniformLocation (the old Shader setters),
+// by name through the reflected location table, by compile time hashed UniformName and by location, and the per frame
+// cost of the SceneUniforms blocks framebuffer.cpp uploads instead.
+// usage: uniforms [frames], run from the repository root so shaders/ can be found
+#include "bench.h"
+
+#include <glfwterminator.h>
+#include <shader.h>
+#include <uniformbuffers.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// the per frame uniforms of the flashlight shader, the multilight shaders read their lights from uniform blocks
+static const char *const UNIFORM_NAMES[] = {
+    "lightPos", "lightdir", "material.shininess",
+    "light.direction", "light.cutOff", "light.outerCutOff",
+    "light.ambient", "light.diffuse", "light.specular",
+    "light.constant", "light.linear", "light.quadratic"};
+static const size_t UNIFORM_COUNT = sizeof(UNIFORM_NAMES) / sizeof(UNIFORM_NAMES[0]);
+
+static constexpr UniformName HASHED_NAMES[] = {
+    UniformName("lightPos"), UniformName("lightdir"), UniformName("material.shininess"),
+    UniformName("light.direction"), UniformName("light.cutOff"), UniformName("light.outerCutOff"),
+    UniformName("light.ambient"), UniformName("light.diffuse"), UniformName("light.specular"),
+    UniformName("light.constant"), UniformName("light.linear"), UniformName("light.quadratic")};
+static_assert(sizeof(HASHED_NAMES) / sizeof(HASHED_NAMES[0]) == sizeof(UNIFORM_NAMES) / sizeof(UNIFORM_NAMES[0]), "name lists must match");
+
+static void report(const char *label, double ms, size_t calls, double baselineNs) {
+    double ns = ms * 1e6 / calls;
+    if (baselineNs > 0.0)
+        printf("%-28s %8.1f ns/call %8.2fx\n", label, ns, baselineNs / ns);
+    else
+        printf("%-28s %8.1f ns/call\n", label, ns);
+}
+
+int main(int argc, char **argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 20000;
+
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+    GlfwTerminator glfwTerminator;
+
+    Shader shader("shaders/lightingshader.vs", "shaders/flashlight.fs");
+    shader.use();
+    printf("%zu active uniforms, %zu set per frame, %d frames\n", shader.uniformCount(), UNIFORM_COUNT, frames);
+
+    std::vector<std::string> names(UNIFORM_NAMES, UNIFORM_NAMES + UNIFORM_COUNT);
+    std::vector<int> locations;
+    std::vector<bool> vec3;  // the rest are floats, each uniform gets the setter of its type
+    for (const std::string &name : names) {
+        vec3.push_back(name.find("Pos") != std::string::npos || name.find("dir") != std::string::npos ||
+                       name.find("ambient") != std::string::npos || name.find("diffuse") != std::string::npos || name.find("specular") != std::string::npos);
+        locations.push_back(shader.uniformLocation(name));
+        if (locations.back() != glGetUniformLocation(shader.ID, name.c_str()))
+            printf("ERROR::BENCH::LOCATION_MISMATCH %s\n", name.c_str());
+    }
+    size_t calls = (size_t)frames * UNIFORM_COUNT;
+
+    // what every setter did before: a std::string from a literal and a glGetUniformLocation per call
+    glFinish();
+    BenchTimer timer;
+    for (int frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < UNIFORM_COUNT; i++) {
+            std::string name = UNIFORM_NAMES[i];
+            if (vec3[i])
+                glUniform3f(glGetUniformLocation(shader.ID, name.c_str()), (float)frame, 0.0f, 0.0f);
+            else
+                glUniform1f(glGetUniformLocation(shader.ID, name.c_str()), (float)frame);
+        }
+    }
+    glFinish();
+    double lookupMs = timer.elapsedMs();
+
+    timer.reset();
+    for (int frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < UNIFORM_COUNT; i++) {
+            if (vec3[i])
+                shader.set3f(UNIFORM_NAMES[i], (float)frame, 0.0f, 0.0f);
+            else
+                shader.set1f(UNIFORM_NAMES[i], (float)frame);
+        }
+    }
+    glFinish();
+    double stringMs = timer.elapsedMs();
+
+    timer.reset();
+    for (int frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < UNIFORM_COUNT; i++) {
+            if (vec3[i])
+                shader.set3f(HASHED_NAMES[i], (float)frame, 0.0f, 0.0f);
+            else
+                shader.set1f(HASHED_NAMES[i], (float)frame);
+        }
+    }
+    glFinish();
+    double hashedMs = timer.elapsedMs();
+
+    timer.reset();
+    for (int frame = 0; frame < frames; frame++) {
+        for (size_t i = 0; i < UNIFORM_COUNT; i++) {
+            if (vec3[i])
+                shader.set3f(locations[i], (float)frame, 0.0f, 0.0f);
+            else
+                shader.set1f(locations[i], (float)frame);
+        }
+    }
+    glFinish();
+    double locationMs = timer.elapsedMs();
+
+    // framebuffer.cpp: the lighting, frame and two view blocks in one buffer write, then a range bind per view
+    SceneUniforms sceneUniforms(2);
+    glFinish();
+    timer.reset();
+    for (int frame = 0; frame < frames; frame++) {
+        sceneUniforms.frame.time = (float)frame;
+        sceneUniforms.lighting.spotLight.position = glm::vec3((float)frame, 0.0f, 0.0f);
+        sceneUniforms.upload();
+        sceneUniforms.bindView(0);
+        sceneUniforms.bindView(1);
+    }
+    glFinish();
+    double blockMs = timer.elapsedMs();
+
+    double baselineNs = lookupMs * 1e6 / calls;
+    report("glGetUniformLocation:", lookupMs, calls, 0.0);
+    report("string, reflected table:", stringMs, calls, baselineNs);
+    report("UniformName:", hashedMs, calls, baselineNs);
+    report("location:", locationMs, calls, baselineNs);
+    // before the blocks framebuffer.cpp set 18 light and camera uniforms per view
+    printf("%-28s %8.1f ns/frame (36 glUniform calls by location: %.1f ns)\n", "uniform blocks, 2 views:", blockMs * 1e6 / frames,
+           locationMs * 1e6 / calls * 36);
+
+    return 0;
+}
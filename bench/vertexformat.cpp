@@ -0,0 +1,102 @@
+// Vertex format benchmark: packs every vertex of the given models into PackedVertex and reports the
+// memory per vertex and the error the quantization introduces, measured with the CPU copy of the shader decode.
+// usage: vertexformat [model paths...], defaults to the assets used by framebuffer.cpp
+#include "bench.h"
+
+#include <model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+struct PackError {
+    size_t vertices = 0;
+    double position = 0.0, positionMax = 0.0;     // world units
+    double positionRelative = 0.0;                // max error over the largest mesh extent
+    double normal = 0.0, normalMax = 0.0;         // degrees
+    double texCoords = 0.0, texCoordsMax = 0.0;   // texcoord units
+    double tangent = 0.0, tangentMax = 0.0;       // degrees between the orthonormalized source tangent and the decoded one
+    size_t tangentVertices = 0;
+    size_t handednessFlips = 0;
+};
+
+static double angleDegrees(glm::vec3 a, glm::vec3 b) {
+    double cosine = glm::dot(glm::normalize(a), glm::normalize(b));
+    return std::acos(std::min(1.0, std::max(-1.0, cosine))) * 180.0 / 3.14159265358979;
+}
+
+static void measure(const Mesh &mesh, PackError &error) {
+    const PackedBounds &bounds = mesh.bounds;
+    double extent = 2.0 * std::max(bounds.scale.x, std::max(bounds.scale.y, bounds.scale.z));
+    for (const Vertex &vertex : mesh.vertices) {
+        PackedVertex packed = packVertex(vertex.Position, vertex.Normal, vertex.TexCoords, vertex.Tangent, vertex.Bitangent, bounds);
+        error.vertices++;
+
+        double position = glm::length(unpackPosition(packed, bounds) - vertex.Position);
+        error.position += position;
+        error.positionMax = std::max(error.positionMax, position);
+        error.positionRelative = std::max(error.positionRelative, position / extent);
+
+        if (glm::dot(vertex.Normal, vertex.Normal) > 0.0f) {
+            double normal = angleDegrees(unpackNormal(packed), vertex.Normal);
+            error.normal += normal;
+            error.normalMax = std::max(error.normalMax, normal);
+        }
+
+        double texCoords = glm::length(unpackTexCoords(packed) - vertex.TexCoords);
+        error.texCoords += texCoords;
+        error.texCoordsMax = std::max(error.texCoordsMax, texCoords);
+
+        // only vertices with a usable tangent frame, the rest get an arbitrary one on purpose
+        glm::vec3 n = glm::normalize(vertex.Normal);
+        glm::vec3 t = vertex.Tangent - n * glm::dot(n, vertex.Tangent);
+        if (glm::dot(vertex.Normal, vertex.Normal) > 0.0f && glm::dot(t, t) > 1e-8f) {
+            glm::vec3 normal, tangent, bitangent;
+            decodeQTangent(unpackQTangent(packed), normal, tangent, bitangent);
+            double angle = angleDegrees(tangent, t);
+            error.tangent += angle;
+            error.tangentMax = std::max(error.tangentMax, angle);
+            error.tangentVertices++;
+            if ((glm::dot(bitangent, vertex.Bitangent) < 0.0f) != (glm::dot(glm::cross(n, t), vertex.Bitangent) < 0.0f))
+                error.handednessFlips++;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    GLFWwindow *window = createBenchContext();
+    if (window == NULL)
+        return -1;
+
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty())
+        paths = {"res/tree/Tree.obj", "res/ground/ground.obj", "res/chair/chair.obj"};
+
+    printf("bytes per vertex: %zu float, %zu packed (%.2fx smaller)\n\n", sizeof(Vertex), sizeof(PackedVertex), (double)sizeof(Vertex) / sizeof(PackedVertex));
+    printf("%-24s %9s %10s %10s %12s %10s %10s %10s %10s %10s %10s\n", "model", "vertices", "float KB", "packed KB",
+           "pos max", "pos rel", "nrm avg", "nrm max", "uv max", "tan avg", "tan max");
+    for (const std::string &path : paths) {
+        Model model(path, false, MODEL_DEFAULT_FLAGS | MODEL_PACKED_VERTICES);
+        PackError error;
+        for (const Mesh &mesh : model.meshes)
+            measure(mesh, error);
+        if (error.vertices == 0)
+            continue;
+        double count = (double)error.vertices;
+        double tangentCount = (double)std::max<size_t>(error.tangentVertices, 1);
+        printf("%-24s %9zu %10.1f %10.1f %12.3g %10.3g %9.4f° %9.4f° %10.3g %9.4f° %9.4f°\n", path.c_str(), error.vertices,
+               count * sizeof(Vertex) / 1024.0, count * sizeof(PackedVertex) / 1024.0, error.positionMax, error.positionRelative,
+               error.normal / count, error.normalMax, error.texCoordsMax, error.tangent / tangentCount, error.tangentMax);
+        if (error.handednessFlips > 0)
+            printf("warning: %zu tangent frames of %s changed handedness\n", error.handednessFlips, path.c_str());
+    }
+
+    glfwTerminate();
+    return 0;
+}
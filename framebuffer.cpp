@@ -4,14 +4,26 @@
 #define GLFW_DLL
 #include <GLFW/glfw3.h>
 #include <camera.h>
+#include <dynamicresolution.h>
+#include <glfwterminator.h>
+#include <glstate.h>
+#include <instancebuffer.h>
+#include <layeredframebuffer.h>
 #include <model.h>
+#include <renderqueue.h>
 #include <shader.h>
+#include <shaderlibrary.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
 
+#include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
+#include <memory>
+#include <vector>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -21,10 +33,15 @@ void mouse_callback(GLFWwindow *window, double xpos, double ypos);
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset);
 glm::mat4 quatRotation(glm::mat4 model, glm::vec3 axis, float angle);
 
-void texGen(unsigned int *texture);
-void fboGen(unsigned int colorBufferTexture, unsigned int *fbo);
-
 const GLuint WIDTH = 1400, HEIGHT = 700;
+// load the lighting variants from the SPIR-V modules of tools/spirvcompile instead of the GLSL text. opt-in: that
+// path hasn't been checked against the GLSL one yet, see bench/spirvcompile
+const bool LIGHTING_FROM_SPIRV = false;
+// GPU time the scene views may take per frame together, their resolution drops to stay under it
+const float SCENE_GPU_MS = 8.0f;
+
+// framebuffer size of the window, kept up to date by framebuffer_size_callback
+int windowWidth = WIDTH, windowHeight = HEIGHT;
 
 // camera
 Camera camera(glm::vec3(0.0f, 1.0f, 3.0f));
@@ -65,24 +82,69 @@ int main() {
         return -1;
     }
 
+    GlfwTerminator glfwTerminator;
+
     // set view port
-    glViewport(0, 0, WIDTH, HEIGHT);
+    glfwGetFramebufferSize(window, &windowWidth, &windowHeight);
+    glViewport(0, 0, windowWidth, windowHeight);
 
-    unsigned int colBufferTex, framebuffer, colBufferTex2, framebuffer2;
-    texGen(&colBufferTex);
-    fboGen(colBufferTex, &framebuffer);
-    texGen(&colBufferTex2);
-    fboGen(colBufferTex2, &framebuffer2);
+    // a layer per view, the size of the half of the window it's shown in and reallocated when that changes. both are
+    // drawn in one pass where the vertex shader can pick the layer, one after the other otherwise
+    std::unique_ptr<LayeredFramebuffer> viewTargets = std::make_unique<LayeredFramebuffer>(std::max(windowWidth / 2, 1), std::max(windowHeight, 1), 2);
+    const bool multiView = LayeredFramebuffer::layerFromVertexShader();
+    // each view draws to as much of its layer as fits its share of SCENE_GPU_MS
+    DynamicResolution viewResolutions[2] = {DynamicResolution(SCENE_GPU_MS / 2.0f), DynamicResolution(SCENE_GPU_MS / 2.0f)};
+    GpuTimer viewTimers[2], multiViewTimer;
 
     // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
     stbi_set_flip_vertically_on_load(true);
 
-    Shader shader("shaders/multilight.vs", "shaders/multilight_alpha.fs");
-    Shader fboShader("shaders/fbo.vs", "shaders/fbo.fs");
-
-    Model tree("res/tree/Tree.obj");
-    Model ground("res/ground/ground.obj");
-    Model chair("res/chair/chair.obj");
+    // programs compile in the background and are rebuilt when their files in shaders/ are saved,
+    // whatever isn't built yet is skipped for the frame
+    ShaderLibrary shaders;
+    shaders.watch("shaders");
+    // the lighting variants come from the SPIR-V modules when LIGHTING_FROM_SPIRV is set and they've been built
+    bool spirv = LIGHTING_FROM_SPIRV && ShaderVariants::spirvAvailable("shaders/multilight_packed.vs", "shaders/multilight.fs");
+    ShaderLanguage lightingLanguage = spirv ? SHADER_SPIRV : SHADER_GLSL;
+    if (lightingLanguage == SHADER_SPIRV)
+        shaders.watch("shaders/spirv");
+    // the scene has a dir light and the camera spotlight but no point lights, foliage needs the alpha test
+    ShaderVariants lighting(shaders, "shaders/multilight_packed.vs", "shaders/multilight.fs", lightingLanguage);
+    const unsigned int sceneVariant = SHADER_DIR_LIGHT | SHADER_SPOT_LIGHT | SHADER_ALPHA_TEST | shaderPointLights(0) | (multiView ? SHADER_MULTI_VIEW : 0);
+    ShaderProgram &fboProgram = shaders.load("shaders/fbo.vs", "shaders/fbo.fs");
+
+    // camera and light data of both views, written to one uniform buffer per frame
+    SceneUniforms sceneUniforms(2);
+    sceneUniforms.lighting.shininess = 64.0f;
+
+    // directional light
+    sceneUniforms.lighting.dirLight.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
+    sceneUniforms.lighting.dirLight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+    sceneUniforms.lighting.dirLight.diffuse = glm::vec3(0.5f, 0.5f, 0.5);
+    sceneUniforms.lighting.dirLight.specular = glm::vec3(0.05f, 0.05f, 0.05f);
+
+    // spotlight, follows the main camera
+    SpotLightData &spotLight = sceneUniforms.lighting.spotLight;
+    spotLight.cutOff = glm::cos(glm::radians(12.5f));
+    spotLight.outerCutOff = glm::cos(glm::radians(20.0f));
+    spotLight.ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+    spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    spotLight.constant = 1.0f;
+    spotLight.linear = 0.09f;
+    spotLight.quadratic = 0.032f;
+
+    // decode model textures in the background, they show a placeholder until they're streamed in
+    AsyncTextureLoader textureLoader;
+    AsyncTextureLoaderScope textureLoaderScope(textureLoader);
+
+    double loadStart = glfwGetTime();
+    const unsigned int modelFlags = MODEL_DEFAULT_FLAGS | MODEL_PACKED_VERTICES;
+    Model tree("res/tree/Tree.obj", false, modelFlags);
+    Model ground("res/ground/ground.obj", false, modelFlags);
+    Model chair("res/chair/chair.obj", false, modelFlags);
+    std::cout << "models loaded in " << (glfwGetTime() - loadStart) * 1000.0 << " ms"
+              << (tree.loadedFromCache && ground.loadedFromCache && chair.loadedFromCache ? " (mesh cache)" : "") << std::endl;
 
     glm::vec3 treePositions[]{
         glm::vec3(3.0f, 0.0f, 3.0f),
@@ -94,6 +156,20 @@ int main() {
         glm::vec3(-3.5f, 0.0f, 0.0f),
         glm::vec3(0.0f, 0.0f, -3.5f)};
 
+    // the props don't move, their transforms are uploaded once and every view draws each model mesh once
+    std::vector<glm::mat4> treeTransforms, chairTransforms;
+    for (unsigned int i = 0; i < 3; i++) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), treePositions[i]);
+        treeTransforms.push_back(quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), 20.0f * i));
+        model = glm::translate(glm::mat4(1.0f), chairPositions[i]);
+        model = quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), 20.0f * i);
+        chairTransforms.push_back(glm::scale(model, glm::vec3(0.5f)));
+    }
+    InstanceBuffer trees(treeTransforms), chairs(chairTransforms);
+    // the scene is queued and sorted by program, textures and depth once per frame, then replayed for each view
+    RenderQueue renderQueue;
+    CommandList sceneCommands;
+
     // plane to use for fbo
     float leftQuad[] = { // vertex attributes for a quad that fills the entire screen in Normalized Device Coordinates.
         // positions   // texCoords
@@ -106,11 +182,12 @@ int main() {
          0.0f,  1.0f,  1.0f, 1.0f
     };
 
+    GLState &state = GLState::shared();
     unsigned int VAO, VBO;
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
 
-    glBindVertexArray(VAO);
+    state.bindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(leftQuad), leftQuad, GL_STATIC_DRAW);
 
@@ -120,7 +197,7 @@ int main() {
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    state.bindVertexArray(0);
 
     // plane to use for other fbo
     float rightQuad[] = { // vertex attributes for a quad that fills the entire screen in Normalized Device Coordinates.
@@ -138,7 +215,7 @@ int main() {
     glGenVertexArrays(1, &VAO2);
     glGenBuffers(1, &VBO2);
 
-    glBindVertexArray(VAO2);
+    state.bindVertexArray(VAO2);
     glBindBuffer(GL_ARRAY_BUFFER, VBO2);
     glBufferData(GL_ARRAY_BUFFER, sizeof(rightQuad), rightQuad, GL_STATIC_DRAW);
 
@@ -148,7 +225,7 @@ int main() {
     glEnableVertexAttribArray(1);
 
     glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    state.bindVertexArray(0);
 
     std::cout << glGetString(GL_VERSION);
 
@@ -164,164 +241,114 @@ int main() {
         // check for input
         processInput(window);
 
-        // ------------------------
-        // left framebuffer
-        // clear data for render and bind fbo
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
-        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_DEPTH_TEST);
-
-        // activate shader
-        shader.use();
-
-        // set camera pos and material shininess
-        shader.set3f("viewPos", camera.Position);
-        shader.set1f("material.shininess", 64.0f);
-
-        // set directional light uniforms
-        shader.set3f("dirLight.direction", glm::vec3(-0.2f, -1.0f, -0.3f));
-        shader.set3f("dirLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-        shader.set3f("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5));
-        shader.set3f("dirLight.specular", glm::vec3(0.05f, 0.05f, 0.05f));
-
-        // set spotlight uniforms
-        shader.set3f("spotLight.position", camera.Position);
-        shader.set3f("spotLight.direction", camera.Front);
-        shader.set1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        shader.set1f("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
-
-        shader.set3f("spotLight.ambient", glm::vec3(0.2f, 0.1f, 0.1f));
-        shader.set3f("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-        shader.set3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-        shader.set1f("spotLight.constant", 1.0f);
-        shader.set1f("spotLight.linear", 0.09f);
-        shader.set1f("spotLight.quadratic", 0.032f);
-
-        // pass projection matrix to shader
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-        shader.setmatrix4("projection", projection);
-
-        // pass view transform matrix
-        glm::mat4 view = camera.GetViewMatrix();
-        shader.setmatrix4("view", view);
-
-        glm::mat4 model(1.0f);
-        shader.setmatrix4("model", model);
-
-        ground.Draw(shader);
-
-        for (unsigned int i = 0; i < 3; i++) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, treePositions[i]);
-            float angle = 20.0f * i;
-            model = quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), angle);
-            shader.setmatrix4("model", model);
-            tree.Draw(shader);
+        // stream up to 8 MB of decoded textures per frame
+        if (textureLoader.update(8 * 1024 * 1024) > 0 && textureLoader.pending() == 0)
+            TextureCache::shared().printStats();
+
+        // swap in finished shader builds and start the ones edits asked for
+        shaders.update();
+
+        // reallocate the view targets for a new window size, a minimized window keeps the old ones
+        int targetWidth = windowWidth / 2, targetHeight = windowHeight;
+        if (targetWidth > 0 && targetHeight > 0 && (viewTargets->width != targetWidth || viewTargets->height != targetHeight)) {
+            viewTargets.reset();
+            viewTargets = std::make_unique<LayeredFramebuffer>(targetWidth, targetHeight, 2);
         }
 
-        for (unsigned int i = 0; i < 3; i++) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, chairPositions[i]);
-            float angle = 20.0f * i;
-            model = quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), angle);
-            model = glm::scale(model, glm::vec3(0.5f));
-            shader.setmatrix4("model", model);
-            chair.Draw(shader);
+        // scale the views by the GPU time of frames that have finished
+        double gpuMs;
+        if (multiView) {
+            // one measurement for both, split by the pixels each drew
+            if (multiViewTimer.poll(gpuMs)) {
+                float pixels[2];
+                for (int i = 0; i < 2; i++)
+                    pixels[i] = viewResolutions[i].scale() * viewResolutions[i].scale();
+                for (int i = 0; i < 2; i++)
+                    viewResolutions[i].update(gpuMs * pixels[i] / (pixels[0] + pixels[1]));
+            }
+        } else {
+            for (int i = 0; i < 2; i++)
+                if (viewTimers[i].poll(gpuMs))
+                    viewResolutions[i].update(gpuMs);
         }
+        glm::ivec2 renderSizes[2];
+        for (int i = 0; i < 2; i++)
+            renderSizes[i] = viewResolutions[i].renderSize(glm::ivec2(viewTargets->width, viewTargets->height));
+
+        // update the uniform blocks of both views at once
+        const float aspect = (float)viewTargets->width / (float)viewTargets->height;
+        sceneUniforms.frame.time = currentFrame;
+        sceneUniforms.frame.deltaTime = deltaTime;
+        sceneUniforms.frame.resolution = glm::vec2(windowWidth, windowHeight);
+        spotLight.position = camera.Position;
+        spotLight.direction = camera.Front;
+        sceneUniforms.views[0] = {glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f), camera.GetViewMatrix(), camera.Position, 0.0f};
+        sceneUniforms.views[1] = {glm::perspective(glm::radians(sideCam.Zoom), aspect, 0.1f, 100.0f), sideCam.GetViewMatrix(), sideCam.Position, 0.0f};
+        sceneUniforms.upload();
+
+        // record the scene once for both views
+        renderQueue.begin(camera.Position);
+        ground.Submit(renderQueue, lighting, sceneVariant, glm::mat4(1.0f));
+        tree.SubmitInstanced(renderQueue, lighting, sceneVariant, trees);
+        chair.SubmitInstanced(renderQueue, lighting, sceneVariant, chairs);
+        renderQueue.record(sceneCommands);
 
         // ------------------------
-        // right framebuffer
+        // view framebuffers
         // clear data for render and bind fbo
-        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer2);
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        glEnable(GL_DEPTH_TEST);
-
-        // activate shader
-        shader.use();
-
-        // set camera pos and material shininess
-        shader.set3f("viewPos", sideCam.Position);
-        shader.set1f("material.shininess", 64.0f);
-
-        // set directional light uniforms
-        shader.set3f("dirLight.direction", glm::vec3(-0.2f, -1.0f, -0.3f));
-        shader.set3f("dirLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-        shader.set3f("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5));
-        shader.set3f("dirLight.specular", glm::vec3(0.05f, 0.05f, 0.05f));
-
-        // set spotlight uniforms
-        shader.set3f("spotLight.position", camera.Position);
-        shader.set3f("spotLight.direction", camera.Front);
-        shader.set1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        shader.set1f("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
-
-        shader.set3f("spotLight.ambient", glm::vec3(0.1f, 0.1f, 0.1f));
-        shader.set3f("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-        shader.set3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-        shader.set1f("spotLight.constant", 1.0f);
-        shader.set1f("spotLight.linear", 0.09f);
-        shader.set1f("spotLight.quadratic", 0.032f);
-
-        // pass projection matrix to shader
-        projection = glm::perspective(glm::radians(sideCam.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-        shader.setmatrix4("projection", projection);
-
-        // pass view transform matrix
-        view = sideCam.GetViewMatrix();
-        shader.setmatrix4("view", view);
-
-        model = glm::mat4(1.0f);
-        shader.setmatrix4("model", model);
-
-        ground.Draw(shader);
-
-        for (unsigned int i = 0; i < 3; i++) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, treePositions[i]);
-            float angle = 20.0f * i;
-            model = quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), angle);
-            shader.setmatrix4("model", model);
-            tree.Draw(shader);
+        state.enable(GL_DEPTH_TEST);
+        if (multiView) {
+            // both cameras at once, each to its own layer and viewport
+            multiViewTimer.begin();
+            state.bindFramebuffer(viewTargets->framebuffer());
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            for (int layer = 0; layer < viewTargets->layers; layer++)
+                glViewportIndexedf(layer, 0.0f, 0.0f, (float)renderSizes[layer].x, (float)renderSizes[layer].y);
+            sceneCommands.replayMultiView(sceneUniforms);
+            multiViewTimer.end();
+        } else {
+            // the left camera, then the side camera
+            for (int layer = 0; layer < viewTargets->layers; layer++) {
+                viewTimers[layer].begin();
+                state.bindFramebuffer(viewTargets->layerFramebuffer(layer));
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glViewport(0, 0, renderSizes[layer].x, renderSizes[layer].y);
+                sceneCommands.replay(sceneUniforms, layer);
+                viewTimers[layer].end();
+            }
         }
 
-        for (unsigned int i = 0; i < 3; i++) {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, chairPositions[i]);
-            float angle = 20.0f * i;
-            model = quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), angle);
-            model = glm::scale(model, glm::vec3(0.5f));
-            shader.setmatrix4("model", model);
-            chair.Draw(shader);
-        }
-
-        // draw framebuffer textures to planes
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        // draw framebuffer textures to planes, stretching what the views drew over their half of the window
+        state.bindFramebuffer(0);
+        glViewport(0, 0, windowWidth, windowHeight);
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glDisable(GL_DEPTH_TEST);
-        fboShader.use();
-        glBindVertexArray(VAO);
-        glBindTexture(GL_TEXTURE_2D, colBufferTex);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-        glBindVertexArray(VAO2);
-        glBindTexture(GL_TEXTURE_2D, colBufferTex2);
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        glBindVertexArray(0);
+        state.disable(GL_DEPTH_TEST);
+        if (Shader *fboShader = fboProgram.get()) {
+            fboShader->use();
+            // an array texture, GLState only tracks 2D ones
+            glBindTextureUnit(0, viewTargets->colorTexture());
+            unsigned int quads[2] = {VAO, VAO2};
+            for (int layer = 0; layer < 2; layer++) {
+                state.bindVertexArray(quads[layer]);
+                fboShader->set1i(shaderuniforms::fbo_fs::LAYER, layer);
+                fboShader->set2f(shaderuniforms::fbo_fs::RENDER_SCALE, glm::vec2(renderSizes[layer]) / glm::vec2(viewTargets->width, viewTargets->height));
+                glDrawArrays(GL_TRIANGLES, 0, 6);
+            }
+        }
 
+        state.endFrame();
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    state.printStats();
+    state.forgetVertexArray(VAO);
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
 
-    glfwTerminate();
     return 0;
 }
 
@@ -385,35 +412,6 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
     glViewport(0, 0, width, height);
-}
-
-void texGen(unsigned int *texture) {
-    glGenTextures(1, texture);
-    glBindTexture(GL_TEXTURE_2D, *texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, WIDTH, HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0);
-}
-
-void fboGen(unsigned int colorBufferTexture, unsigned int *fbo) {
-    glGenFramebuffers(1, fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, *fbo);
-
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorBufferTexture, 0);
-
-    // creating a render buffer object for depth and stencil testing
-    unsigned int rbo;
-    glGenRenderbuffers(1, &rbo);
-    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, WIDTH, HEIGHT);
-    glBindRenderbuffer(GL_RENDERBUFFER, 0);
-
-    // attach the rbo to fbo's depth and stencil buffer
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
-
-    // check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "ERROR::FRAMEBUFFER:: framebuffer is not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    windowWidth = width;
+    windowHeight = height;
 }
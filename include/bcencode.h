@@ -0,0 +1,589 @@
+#ifndef BCENCODE_H
+#define BCENCODE_H
+
+#include <threadpool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// CPU encoder for the block compressed formats desktop GL can sample directly:
+//   BC1 - RGB, 4 bpp, opaque color maps
+//   BC3 - RGBA, 8 bpp, BC1 color plus a BC4 alpha block
+//   BC5 - RG, 8 bpp, two BC4 blocks, for tangent space normal maps (z is rebuilt in the shader)
+//   BC7 - RGBA, 8 bpp, mode 6 only (one subset, 4 bit indices)
+// All blocks are 4x4 texels. The inner loops work on small float arrays so the compiler can vectorize them.
+enum BlockFormat {
+    BLOCK_BC1,
+    BLOCK_BC3,
+    BLOCK_BC5,
+    BLOCK_BC7
+};
+
+inline size_t blockBytes(BlockFormat format) {
+    return format == BLOCK_BC1 ? 8 : 16;
+}
+
+inline size_t compressedSize(BlockFormat format, int width, int height) {
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+// ------------------------------------------------------------------------
+// BC1
+
+inline uint16_t packColor565(const float color[3]) {
+    int r = std::min(31, std::max(0, (int)std::lround(color[0] * 31.0f / 255.0f)));
+    int g = std::min(63, std::max(0, (int)std::lround(color[1] * 63.0f / 255.0f)));
+    int b = std::min(31, std::max(0, (int)std::lround(color[2] * 31.0f / 255.0f)));
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline void unpackColor565(uint16_t packed, float color[3]) {
+    int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+    color[0] = (float)((r << 3) | (r >> 2));
+    color[1] = (float)((g << 2) | (g >> 4));
+    color[2] = (float)((b << 3) | (b >> 2));
+}
+
+// picks the nearest of the four palette entries for every texel, returns the summed squared error
+inline float assignBC1Indices(const float pixels[16][3], uint16_t c0, uint16_t c1, uint32_t &indices) {
+    float palette[4][3];
+    unpackColor565(c0, palette[0]);
+    unpackColor565(c1, palette[1]);
+    for (int c = 0; c < 3; c++) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+    indices = 0;
+    float total = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float best = 1e30f;
+        int bestIndex = 0;
+        for (int p = 0; p < 4; p++) {
+            float dr = pixels[i][0] - palette[p][0], dg = pixels[i][1] - palette[p][1], db = pixels[i][2] - palette[p][2];
+            float error = dr * dr + dg * dg + db * db;
+            if (error < best) {
+                best = error;
+                bestIndex = p;
+            }
+        }
+        indices |= (uint32_t)bestIndex << (2 * i);
+        total += best;
+    }
+    return total;
+}
+
+// fits the endpoints along the principal axis of the block's colors, then refines them with least squares
+inline void encodeBC1Block(const uint8_t rgba[64], uint8_t out[8]) {
+    float pixels[16][3];
+    float mean[3] = {0.0f, 0.0f, 0.0f};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 3; c++) {
+            pixels[i][c] = rgba[i * 4 + c];
+            mean[c] += pixels[i][c] / 16.0f;
+        }
+    }
+
+    float cov[6] = {0, 0, 0, 0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        float r = pixels[i][0] - mean[0], g = pixels[i][1] - mean[1], b = pixels[i][2] - mean[2];
+        cov[0] += r * r;
+        cov[1] += r * g;
+        cov[2] += r * b;
+        cov[3] += g * g;
+        cov[4] += g * b;
+        cov[5] += b * b;
+    }
+    // power iteration for the principal axis
+    float axis[3] = {1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+        if (length < 1e-6f)
+            break;
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    float axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    for (int i = 0; i < 16; i++) {
+        float t = ((pixels[i][0] - mean[0]) * axis[0] + (pixels[i][1] - mean[1]) * axis[1] + (pixels[i][2] - mean[2]) * axis[2]) / axisLength2;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    // inset the endpoints a little, the extremes rarely sit exactly on a palette entry
+    float inset = (maxT - minT) / 16.0f;
+    minT += inset;
+    maxT -= inset;
+    float end0[3], end1[3];
+    for (int c = 0; c < 3; c++) {
+        end0[c] = mean[c] + axis[c] * maxT;
+        end1[c] = mean[c] + axis[c] * minT;
+    }
+
+    uint16_t c0 = packColor565(end0), c1 = packColor565(end1);
+    uint32_t indices;
+    float error = assignBC1Indices(pixels, c0, c1, indices);
+
+    // least squares refit of the endpoints for the chosen indices
+    static const float weights[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    for (int iteration = 0; iteration < 2 && error > 0.0f; iteration++) {
+        float aa = 0, ab = 0, bb = 0, ax[3] = {0, 0, 0}, bx[3] = {0, 0, 0};
+        for (int i = 0; i < 16; i++) {
+            float a = weights[(indices >> (2 * i)) & 3], b = 1.0f - a;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int c = 0; c < 3; c++) {
+                ax[c] += a * pixels[i][c];
+                bx[c] += b * pixels[i][c];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f)
+            break;
+        for (int c = 0; c < 3; c++) {
+            end0[c] = (ax[c] * bb - bx[c] * ab) / det;
+            end1[c] = (bx[c] * aa - ax[c] * ab) / det;
+        }
+        uint16_t n0 = packColor565(end0), n1 = packColor565(end1);
+        if (n0 < n1)
+            std::swap(n0, n1);
+        uint32_t newIndices;
+        float newError = assignBC1Indices(pixels, n0, n1, newIndices);
+        if (newError >= error)
+            break;
+        c0 = n0;
+        c1 = n1;
+        indices = newIndices;
+        error = newError;
+    }
+
+    // c0 > c1 selects the four color mode, swapping the endpoints swaps palette entries 0<->1 and 2<->3
+    if (c0 < c1) {
+        std::swap(c0, c1);
+        indices ^= 0x55555555;
+    } else if (c0 == c1) {
+        indices = 0;
+    }
+    out[0] = c0 & 0xff;
+    out[1] = c0 >> 8;
+    out[2] = c1 & 0xff;
+    out[3] = c1 >> 8;
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (indices >> (8 * i)) & 0xff;
+}
+
+inline void decodeBC1Block(const uint8_t in[8], uint8_t rgba[64], bool forceFourColor = false) {
+    uint16_t c0 = in[0] | (in[1] << 8), c1 = in[2] | (in[3] << 8);
+    float palette[4][4];
+    unpackColor565(c0, palette[0]);
+    unpackColor565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255.0f;
+    for (int c = 0; c < 3; c++) {
+        if (c0 > c1 || forceFourColor) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+            palette[3][c] = 0.0f;
+        }
+    }
+    if (c0 <= c1 && !forceFourColor)
+        palette[3][3] = 0.0f;
+    uint32_t indices = in[4] | (in[5] << 8) | (in[6] << 16) | ((uint32_t)in[7] << 24);
+    for (int i = 0; i < 16; i++) {
+        int index = (indices >> (2 * i)) & 3;
+        for (int c = 0; c < 4; c++)
+            rgba[i * 4 + c] = (uint8_t)std::lround(palette[index][c]);
+    }
+}
+
+// ------------------------------------------------------------------------
+// BC4 (single channel, used for BC3 alpha and both BC5 channels)
+
+inline void encodeBC4Block(const uint8_t rgba[64], int channel, uint8_t out[8]) {
+    int minValue = 255, maxValue = 0;
+    for (int i = 0; i < 16; i++) {
+        minValue = std::min(minValue, (int)rgba[i * 4 + channel]);
+        maxValue = std::max(maxValue, (int)rgba[i * 4 + channel]);
+    }
+    // e0 > e1 selects the eight value mode: e0, e1 and six interpolated values
+    out[0] = (uint8_t)maxValue;
+    out[1] = (uint8_t)minValue;
+    float palette[8];
+    palette[0] = (float)maxValue;
+    palette[1] = (float)minValue;
+    for (int k = 1; k < 7; k++)
+        palette[k + 1] = ((7 - k) * (float)maxValue + k * (float)minValue) / 7.0f;
+
+    uint64_t indices = 0;
+    if (maxValue != minValue) {
+        for (int i = 0; i < 16; i++) {
+            float value = rgba[i * 4 + channel];
+            int bestIndex = 0;
+            float best = 1e30f;
+            for (int p = 0; p < 8; p++) {
+                float error = std::fabs(value - palette[p]);
+                if (error < best) {
+                    best = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= (uint64_t)bestIndex << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (indices >> (8 * i)) & 0xff;
+}
+
+inline void decodeBC4Block(const uint8_t in[8], uint8_t rgba[64], int channel) {
+    float palette[8];
+    palette[0] = in[0];
+    palette[1] = in[1];
+    if (in[0] > in[1]) {
+        for (int k = 1; k < 7; k++)
+            palette[k + 1] = ((7 - k) * palette[0] + k * palette[1]) / 7.0f;
+    } else {
+        for (int k = 1; k < 5; k++)
+            palette[k + 1] = ((5 - k) * palette[0] + k * palette[1]) / 5.0f;
+        palette[6] = 0.0f;
+        palette[7] = 255.0f;
+    }
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++)
+        indices |= (uint64_t)in[2 + i] << (8 * i);
+    for (int i = 0; i < 16; i++)
+        rgba[i * 4 + channel] = (uint8_t)std::lround(palette[(indices >> (3 * i)) & 7]);
+}
+
+// ------------------------------------------------------------------------
+// BC7 mode 6: RGBA endpoints with 7 bits per channel plus one p-bit per endpoint, 4 bit indices
+
+const int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+class BitWriter128 {
+   public:
+    uint8_t bytes[16] = {};
+    int position = 0;
+
+    void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, position++) {
+            if (value & (1u << i))
+                bytes[position >> 3] |= (uint8_t)(1u << (position & 7));
+        }
+    }
+};
+
+inline uint32_t readBits128(const uint8_t in[16], int &position, int bits) {
+    uint32_t value = 0;
+    for (int i = 0; i < bits; i++, position++)
+        value |= (uint32_t)((in[position >> 3] >> (position & 7)) & 1) << i;
+    return value;
+}
+
+inline int bc7Interpolate(int e0, int e1, int index) {
+    return (e0 * (64 - BC7_WEIGHTS4[index]) + e1 * BC7_WEIGHTS4[index] + 32) >> 6;
+}
+
+// quantizes both endpoints for every p-bit combination and keeps the one with the lowest error
+inline float fitBC7Mode6(const float pixels[16][4], const float end0[4], const float end1[4], int q0[4], int q1[4], int &p0, int &p1, uint64_t &indices) {
+    float bestError = 1e30f;
+    for (int pa = 0; pa < 2; pa++) {
+        for (int pb = 0; pb < 2; pb++) {
+            int a[4], b[4], full0[4], full1[4];
+            for (int c = 0; c < 4; c++) {
+                a[c] = std::min(127, std::max(0, (int)std::lround((end0[c] - pa) / 2.0f)));
+                b[c] = std::min(127, std::max(0, (int)std::lround((end1[c] - pb) / 2.0f)));
+                full0[c] = (a[c] << 1) | pa;
+                full1[c] = (b[c] << 1) | pb;
+            }
+            float palette[16][4];
+            for (int index = 0; index < 16; index++)
+                for (int c = 0; c < 4; c++)
+                    palette[index][c] = (float)bc7Interpolate(full0[c], full1[c], index);
+
+            uint64_t candidate = 0;
+            float error = 0.0f;
+            for (int i = 0; i < 16; i++) {
+                float best = 1e30f;
+                int bestIndex = 0;
+                for (int index = 0; index < 16; index++) {
+                    float d0 = pixels[i][0] - palette[index][0], d1 = pixels[i][1] - palette[index][1];
+                    float d2 = pixels[i][2] - palette[index][2], d3 = pixels[i][3] - palette[index][3];
+                    float e = d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3;
+                    if (e < best) {
+                        best = e;
+                        bestIndex = index;
+                    }
+                }
+                candidate |= (uint64_t)bestIndex << (4 * i);
+                error += best;
+            }
+            if (error < bestError) {
+                bestError = error;
+                std::memcpy(q0, a, sizeof(a));
+                std::memcpy(q1, b, sizeof(b));
+                p0 = pa;
+                p1 = pb;
+                indices = candidate;
+            }
+        }
+    }
+    return bestError;
+}
+
+inline void encodeBC7Block(const uint8_t rgba[64], uint8_t out[16]) {
+    float pixels[16][4];
+    float mean[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        for (int c = 0; c < 4; c++) {
+            pixels[i][c] = rgba[i * 4 + c];
+            mean[c] += pixels[i][c] / 16.0f;
+        }
+    }
+    // principal axis of the RGBA point cloud
+    float cov[4][4] = {};
+    for (int i = 0; i < 16; i++)
+        for (int a = 0; a < 4; a++)
+            for (int b = 0; b < 4; b++)
+                cov[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+    float axis[4] = {1, 1, 1, 1};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {0, 0, 0, 0};
+        for (int a = 0; a < 4; a++)
+            for (int b = 0; b < 4; b++)
+                next[a] += cov[a][b] * axis[b];
+        float length = std::max(std::max(std::fabs(next[0]), std::fabs(next[1])), std::max(std::fabs(next[2]), std::fabs(next[3])));
+        if (length < 1e-6f)
+            break;
+        for (int a = 0; a < 4; a++)
+            axis[a] = next[a] / length;
+    }
+    float axisLength2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3];
+    float minT = 1e30f, maxT = -1e30f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < 4; c++)
+            t += (pixels[i][c] - mean[c]) * axis[c];
+        t /= axisLength2;
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    float end0[4], end1[4];
+    for (int c = 0; c < 4; c++) {
+        end0[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minT));
+        end1[c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maxT));
+    }
+
+    int q0[4], q1[4], p0, p1;
+    uint64_t indices;
+    float error = fitBC7Mode6(pixels, end0, end1, q0, q1, p0, p1, indices);
+
+    // one least squares refit of the endpoints for the chosen indices
+    float aa = 0, ab = 0, bb = 0, ax[4] = {0, 0, 0, 0}, bx[4] = {0, 0, 0, 0};
+    for (int i = 0; i < 16; i++) {
+        float b = BC7_WEIGHTS4[(indices >> (4 * i)) & 15] / 64.0f, a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < 4; c++) {
+            ax[c] += a * pixels[i][c];
+            bx[c] += b * pixels[i][c];
+        }
+    }
+    float det = aa * bb - ab * ab;
+    if (error > 0.0f && std::fabs(det) > 1e-6f) {
+        float refit0[4], refit1[4];
+        for (int c = 0; c < 4; c++) {
+            refit0[c] = std::min(255.0f, std::max(0.0f, (ax[c] * bb - bx[c] * ab) / det));
+            refit1[c] = std::min(255.0f, std::max(0.0f, (bx[c] * aa - ax[c] * ab) / det));
+        }
+        int r0[4], r1[4], rp0, rp1;
+        uint64_t refitIndices;
+        if (fitBC7Mode6(pixels, refit0, refit1, r0, r1, rp0, rp1, refitIndices) < error) {
+            std::memcpy(q0, r0, sizeof(r0));
+            std::memcpy(q1, r1, sizeof(r1));
+            p0 = rp0;
+            p1 = rp1;
+            indices = refitIndices;
+        }
+    }
+
+    // the anchor (first) index is stored with 3 bits, so its top bit must be clear
+    if ((indices & 15) >= 8) {
+        std::swap(q0, q1);
+        std::swap(p0, p1);
+        uint64_t flipped = 0;
+        for (int i = 0; i < 16; i++)
+            flipped |= (uint64_t)(15 - ((indices >> (4 * i)) & 15)) << (4 * i);
+        indices = flipped;
+    }
+
+    BitWriter128 writer;
+    writer.write(1u << 6, 7);  // mode 6
+    for (int c = 0; c < 4; c++) {
+        writer.write(q0[c], 7);
+        writer.write(q1[c], 7);
+    }
+    writer.write(p0, 1);
+    writer.write(p1, 1);
+    writer.write((uint32_t)(indices & 7), 3);
+    for (int i = 1; i < 16; i++)
+        writer.write((uint32_t)((indices >> (4 * i)) & 15), 4);
+    std::memcpy(out, writer.bytes, 16);
+}
+
+// decodes mode 6 blocks, anything else (we never write it) comes out magenta
+inline void decodeBC7Block(const uint8_t in[16], uint8_t rgba[64]) {
+    if ((in[0] & 0x7f) != 0x40) {
+        for (int i = 0; i < 16; i++) {
+            rgba[i * 4 + 0] = 255;
+            rgba[i * 4 + 1] = 0;
+            rgba[i * 4 + 2] = 255;
+            rgba[i * 4 + 3] = 255;
+        }
+        return;
+    }
+    int position = 7;
+    int e0[4], e1[4];
+    for (int c = 0; c < 4; c++) {
+        e0[c] = readBits128(in, position, 7);
+        e1[c] = readBits128(in, position, 7);
+    }
+    int p0 = readBits128(in, position, 1), p1 = readBits128(in, position, 1);
+    for (int c = 0; c < 4; c++) {
+        e0[c] = (e0[c] << 1) | p0;
+        e1[c] = (e1[c] << 1) | p1;
+    }
+    for (int i = 0; i < 16; i++) {
+        int index = readBits128(in, position, i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; c++)
+            rgba[i * 4 + c] = (uint8_t)bc7Interpolate(e0[c], e1[c], index);
+    }
+}
+
+// ------------------------------------------------------------------------
+// whole images
+
+inline void encodeBlock(BlockFormat format, const uint8_t rgba[64], uint8_t *out) {
+    switch (format) {
+        case BLOCK_BC1:
+            encodeBC1Block(rgba, out);
+            break;
+        case BLOCK_BC3:
+            encodeBC4Block(rgba, 3, out);
+            encodeBC1Block(rgba, out + 8);
+            break;
+        case BLOCK_BC5:
+            encodeBC4Block(rgba, 0, out);
+            encodeBC4Block(rgba, 1, out + 8);
+            break;
+        case BLOCK_BC7:
+            encodeBC7Block(rgba, out);
+            break;
+    }
+}
+
+inline void decodeBlock(BlockFormat format, const uint8_t *in, uint8_t rgba[64]) {
+    switch (format) {
+        case BLOCK_BC1:
+            decodeBC1Block(in, rgba);
+            break;
+        case BLOCK_BC3:
+            decodeBC1Block(in + 8, rgba, true);
+            decodeBC4Block(in, rgba, 3);
+            break;
+        case BLOCK_BC5:
+            for (int i = 0; i < 16; i++) {
+                rgba[i * 4 + 2] = 0;
+                rgba[i * 4 + 3] = 255;
+            }
+            decodeBC4Block(in, rgba, 0);
+            decodeBC4Block(in + 8, rgba, 1);
+            break;
+        case BLOCK_BC7:
+            decodeBC7Block(in, rgba);
+            break;
+    }
+}
+
+// compresses an RGBA8 image, rows of blocks are spread over the thread pool.
+// texels past the right/bottom edge repeat the last row/column.
+inline std::vector<uint8_t> compressImage(const uint8_t *rgba, int width, int height, BlockFormat format) {
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t stride = blockBytes(format);
+    std::vector<uint8_t> out((size_t)blocksX * blocksY * stride);
+    parallelFor((size_t)blocksY, [&](size_t by) {
+        uint8_t block[64];
+        for (int bx = 0; bx < blocksX; bx++) {
+            for (int y = 0; y < 4; y++) {
+                int sy = std::min(height - 1, (int)by * 4 + y);
+                for (int x = 0; x < 4; x++) {
+                    int sx = std::min(width - 1, bx * 4 + x);
+                    std::memcpy(&block[(y * 4 + x) * 4], &rgba[((size_t)sy * width + sx) * 4], 4);
+                }
+            }
+            encodeBlock(format, block, &out[(by * blocksX + bx) * stride]);
+        }
+    });
+    return out;
+}
+
+inline std::vector<uint8_t> decompressImage(const uint8_t *blocks, int width, int height, BlockFormat format) {
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t stride = blockBytes(format);
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            uint8_t block[64];
+            decodeBlock(format, &blocks[((size_t)by * blocksX + bx) * stride], block);
+            for (int y = 0; y < 4 && by * 4 + y < height; y++)
+                for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+                    std::memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], &block[(y * 4 + x) * 4], 4);
+        }
+    }
+    return rgba;
+}
+
+// 2x2 box filter for the next mip level, odd sizes clamp at the edge
+inline std::vector<uint8_t> downsampleImage(const uint8_t *rgba, int width, int height, int &outWidth, int &outHeight) {
+    outWidth = std::max(1, width / 2);
+    outHeight = std::max(1, height / 2);
+    std::vector<uint8_t> out((size_t)outWidth * outHeight * 4);
+    for (int y = 0; y < outHeight; y++) {
+        int y0 = std::min(height - 1, y * 2), y1 = std::min(height - 1, y * 2 + 1);
+        for (int x = 0; x < outWidth; x++) {
+            int x0 = std::min(width - 1, x * 2), x1 = std::min(width - 1, x * 2 + 1);
+            for (int c = 0; c < 4; c++) {
+                int sum = rgba[((size_t)y0 * width + x0) * 4 + c] + rgba[((size_t)y0 * width + x1) * 4 + c] +
+                          rgba[((size_t)y1 * width + x0) * 4 + c] + rgba[((size_t)y1 * width + x1) * 4 + c];
+                out[((size_t)y * outWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+    return out;
+}
+
+// peak signal to noise ratio in dB over the channels the format stores
+inline double computePSNR(const uint8_t *original, const uint8_t *decoded, int width, int height, BlockFormat format) {
+    int channels = format == BLOCK_BC1 ? 3 : (format == BLOCK_BC5 ? 2 : 4);
+    double sum = 0.0;
+    size_t count = (size_t)width * height;
+    for (size_t i = 0; i < count; i++) {
+        for (int c = 0; c < channels; c++) {
+            double d = (double)original[i * 4 + c] - decoded[i * 4 + c];
+            sum += d * d;
+        }
+    }
+    double mse = sum / ((double)count * channels);
+    return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <vector>
+
+// GPU time of the commands between begin() and end(), measured with GL_TIME_ELAPSED queries. The queries go round
+// a ring a few frames long and results are only read once they're available, so measuring never waits for the GPU.
+// one begin()/end() pair per frame. the context has to outlive it
+class GpuTimer {
+   public:
+    explicit GpuTimer(size_t frames = 4) : queries(frames), pending(frames, false) {
+        glGenQueries((int)queries.size(), queries.data());
+    }
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    ~GpuTimer() {
+        glDeleteQueries((int)queries.size(), queries.data());
+    }
+
+    // starts the query of this frame, skipped while every query of the ring is still in flight
+    void begin() {
+        running = !pending[next];
+        if (running)
+            glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+    }
+
+    void end() {
+        if (!running)
+            return;
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[next] = true;
+        next = (next + 1) % queries.size();
+        running = false;
+    }
+
+    // the newest finished measurement in ms, false when none finished since the last call
+    bool poll(double &ms) {
+        bool found = false;
+        // oldest first, so the newest ends up in ms
+        for (size_t i = 0; i < queries.size(); i++) {
+            size_t query = (next + i) % queries.size();
+            if (!pending[query])
+                continue;
+            int available = 0;
+            glGetQueryObjectiv(queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[query], GL_QUERY_RESULT, &nanoseconds);
+            pending[query] = false;
+            ms = (double)nanoseconds / 1000000.0;
+            found = true;
+        }
+        return found;
+    }
+
+   private:
+    std::vector<unsigned int> queries;
+    std::vector<bool> pending;  // ended but not read yet
+    size_t next = 0;
+    bool running = false;
+};
+
+// Picks the fraction of a view's render target to draw into so its GPU time stays near targetMs. The cost of a view
+// goes with its pixel count, the square of the scale, so each measurement moves the scale part of the way to
+// sqrt(targetMs / ms) of the current one. Scales are rounded to steps of 1/32 so small changes in timing don't
+// change the viewport every frame. the rendered part is stretched over the whole view when it's composited
+class DynamicResolution {
+   public:
+    float targetMs;
+    float minScale, maxScale;
+
+    explicit DynamicResolution(float targetMs, float minScale = 0.5f, float maxScale = 1.0f) : targetMs(targetMs), minScale(minScale), maxScale(maxScale) {}
+
+    // feeds a GPU time of the view drawn at the current scale
+    void update(double ms) {
+        if (ms <= 0.0)
+            return;
+        float wanted = smoothScale * (float)std::sqrt(targetMs / ms);
+        // damped, measurements of single frames jump around
+        smoothScale += (wanted - smoothScale) * 0.25f;
+        smoothScale = std::max(minScale, std::min(maxScale, smoothScale));
+        float stepped = std::round(smoothScale * 32.0f) / 32.0f;
+        currentScale = std::max(minScale, std::min(maxScale, stepped));
+    }
+
+    float scale() const {
+        return currentScale;
+    }
+
+    // the part of a target of targetSize to draw into, at least a pixel
+    glm::ivec2 renderSize(glm::ivec2 targetSize) const {
+        return glm::max(glm::ivec2(glm::vec2(targetSize) * currentScale + 0.5f), glm::ivec2(1));
+    }
+
+   private:
+    float smoothScale = 1.0f, currentScale = 1.0f;
+};
+
+#endif
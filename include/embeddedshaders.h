@@ -0,0 +1,834 @@
+// generated by tools/shaderembed from shaders/, don't edit
+#ifndef EMBEDDEDSHADERS_H
+#define EMBEDDEDSHADERS_H
+
+#include <string_view>
+
+struct EmbeddedShader {
+    const char *path;
+    std::string_view source;
+};
+
+inline constexpr EmbeddedShader EMBEDDED_SHADERS[] = {
+    {"shaders/1.model_loading.fs", R"SHADER(#version 460 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D texture_diffuse1;
+
+void main()
+{    
+    FragColor = texture(texture_diffuse1, TexCoords);
+})SHADER"},
+    {"shaders/1.model_loading.vs", R"SHADER(#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec2 TexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    TexCoords = aTexCoords;    
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+})SHADER"},
+    {"shaders/4.6.shader.fs", R"SHADER(#version 460 core
+out vec4 fragColor;
+
+in vec3 ourColor;
+in vec2 TexCoord;
+
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+void main()
+{
+    fragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord * vec2(-1, 1)), 0.4);
+})SHADER"},
+    {"shaders/4.6.shader.vs", R"SHADER(#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aColor;
+
+out vec3 ourColor;
+out vec2 TexCoord;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    ourColor = aColor;
+    TexCoord = aTexCoord;
+})SHADER"},
+    {"shaders/directionlight.fs", R"SHADER(#version 460 core
+out vec4 FragColor;
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct Light {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+uniform Material material;
+uniform Light light;
+
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+
+void main()
+{
+    // ambient
+    vec3 ambient = light.ambient * texture(material.diffuse, TexCoords).rgb;
+
+    // diffuse
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(-light.direction);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * texture(material.diffuse, TexCoords).rgb;
+
+    // specular
+    vec3 viewDir = normalize(-FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = light.specular * spec * texture(material.specular, TexCoords).rgb;
+
+    vec3 result = ambient + diffuse + specular;
+    FragColor = vec4(result, 1.0);
+})SHADER"},
+    {"shaders/directionlight.vs", R"SHADER(#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec2 TexCoords;
+
+void main()
+{
+    FragPos = vec3(view * model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(view * model))) * aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+} )SHADER"},
+    {"shaders/fbo.fs", R"SHADER(#version 460 core
+out vec4 FragColor;
+  
+in vec2 TexCoords;
+
+// one layer per view, see LayeredFramebuffer in include/layeredframebuffer.h
+uniform sampler2DArray screenTexture;
+uniform int layer;
+// the part of the layer that was drawn, dynamic resolution renders less than all of it and it's stretched over the quad
+uniform vec2 renderScale;
+
+const float offset = 1.0 / 300.0;
+
+void main() {
+    // clamped half a texel inside the drawn part, so filtering doesn't pull in what's outside of it
+    vec2 halfTexel = 0.5 / vec2(textureSize(screenTexture, 0).xy);
+    vec2 uv = min(TexCoords * renderScale, renderScale - halfTexel);
+
+    vec2 offsets[9] = vec2[](
+        vec2(-offset,  offset), // top-left
+        vec2( 0.0f,    offset), // top-center
+        vec2( offset,  offset), // top-right
+        vec2(-offset,  0.0f),   // center-left
+        vec2( 0.0f,    0.0f),   // center-center
+        vec2( offset,  0.0f),   // center-right
+        vec2(-offset, -offset), // bottom-left
+        vec2( 0.0f,   -offset), // bottom-center
+        vec2( offset, -offset)  // bottom-right
+    );
+
+    /* float sharpenKernel[9] = float[](
+        -1, -1, -1,
+        -1,  9, -1,
+        -1, -1, -1
+    ); */
+
+    /* float edgeKernel[9] = float[](
+        1, 1, 1,
+        1,-8, 1,
+        1, 1, 1
+    ); */
+
+    /* float blurKernel[9] = float[](
+        1.0 / 16, 2.0 / 16, 1.0 / 16,
+        2.0 / 16, 4.0 / 16, 2.0 / 16,
+        1.0 / 16, 2.0 / 16, 1.0 / 16  
+    ); */
+
+    /* vec3 sampleTex[9];
+    for (int i = 0; i < 9; i++) {
+        sampleTex[i] = vec3(texture(screenTexture, vec3(uv + offsets[i], layer)));
+    }
+    vec3 col = vec3(0.0);
+    for (int i = 0; i < 9; i++) {
+        col += sampleTex[i] * edgeKernel[i];
+    } */
+    vec3 col = vec3(texture(screenTexture, vec3(uv, layer)));
+
+    FragColor = vec4(col, 1.0);
+})SHADER"},
+    {"shaders/fbo.vs", R"SHADER(#version 460 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoords;
+
+out vec2 TexCoords;
+
+void main() {
+    gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0); 
+    TexCoords = aTexCoords;
+} )SHADER"},
+    {"shaders/flashlight.fs", R"SHADER(#version 460 core
+out vec4 FragColor;
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct Light {
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+uniform Material material;
+uniform Light light;
+
+in vec3 LightPos;
+in vec3 lightDirection;
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+
+void main()
+{
+    vec3 lightDir = normalize(LightPos - FragPos);
+
+    float theta = dot(lightDir, normalize(-lightDirection));
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta- light.outerCutOff) / epsilon, 0.0, 1.0);
+
+    float dist = length(LightPos - FragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * dist + 
+                light.quadratic * (dist * dist));
+
+    // ambient
+    vec3 ambient = light.ambient * texture(material.diffuse, TexCoords).rgb;
+
+    // diffuse
+    vec3 norm = normalize(Normal);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * texture(material.diffuse, TexCoords).rgb;
+
+    // specular
+    vec3 viewDir = normalize(-FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = light.specular * spec * texture(material.specular, TexCoords).rgb;
+
+    //ambient  *= attenuation; 
+    diffuse  *= attenuation * intensity;
+    specular *= attenuation * intensity;
+
+    vec3 result = ambient + diffuse + specular;
+    FragColor = vec4(result, 1.0);
+    
+})SHADER"},
+    {"shaders/lightcube.fs", R"SHADER(#version 330 core
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0); // set all 4 vector values to 1.0
+})SHADER"},
+    {"shaders/lightingshader.fs", R"SHADER(#version 460 core
+out vec4 FragColor;
+
+struct Material {
+    sampler2D diffuse;
+    sampler2D specular;
+    float shininess;
+};
+
+struct Light {
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+uniform Material material;
+uniform Light light;
+
+in vec3 LightPos;
+in vec2 TexCoords;
+in vec3 Normal;
+in vec3 FragPos;
+
+void main()
+{
+    float dist = length(LightPos - FragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * dist + 
+    		    light.quadratic * (dist * dist));
+
+    // ambient
+    vec3 ambient = light.ambient * texture(material.diffuse, TexCoords).rgb;
+
+    // diffuse
+    vec3 norm = normalize(Normal);
+    vec3 lightDir = normalize(LightPos - FragPos);
+    float diff = max(dot(norm, lightDir), 0.0);
+    vec3 diffuse = light.diffuse * diff * texture(material.diffuse, TexCoords).rgb;
+
+    // specular
+    vec3 viewDir = normalize(-FragPos);
+    vec3 reflectDir = reflect(-lightDir, norm);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    vec3 specular = light.specular * spec * texture(material.specular, TexCoords).rgb;
+
+    ambient  *= attenuation; 
+    diffuse  *= attenuation;
+    specular *= attenuation;  
+
+    vec3 result = ambient + diffuse + specular;
+    FragColor = vec4(result, 1.0);
+})SHADER"},
+    {"shaders/lightingshader.vs", R"SHADER(#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 lightPos;
+uniform vec3 lightdir;
+
+out vec3 Normal;
+out vec3 FragPos;
+out vec3 LightPos;
+out vec2 TexCoords;
+out vec3 lightDirection;
+
+void main()
+{
+    FragPos = vec3(view * model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(view * model))) * aNormal;
+    LightPos = vec3(view * vec4(lightPos, 1.0));
+    TexCoords = aTexCoords;
+    lightDirection = vec3(view * vec4(lightdir, 0.0));
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+} )SHADER"},
+    {"shaders/multilight.fs", R"SHADER(#version 460 core
+// variant values: #defines injected by ShaderVariants (include/shadervariants.h) when built from source, specialization
+// constants when built from SPIR-V (tools/spirvcompile.cpp). without them every light is evaluated.
+// NORMAL_MAP changes the stage interface, so it stays a define and gets its own SPIR-V module.
+#ifdef GL_SPIRV
+layout (constant_id = 0) const int POINT_LIGHT_COUNT = 4;
+layout (constant_id = 1) const int DIR_LIGHT = 1;
+layout (constant_id = 2) const int SPOT_LIGHT = 1;
+layout (constant_id = 3) const int ALPHA_TEST = 0;  // discard below 0.4 alpha, light back faces from their side
+#else
+#ifndef POINT_LIGHT_COUNT
+#define POINT_LIGHT_COUNT 4
+#endif
+#ifndef DIR_LIGHT
+#define DIR_LIGHT 1
+#endif
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+#ifndef ALPHA_TEST
+#define ALPHA_TEST 0
+#endif
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+
+layout (location = 0) out vec4 FragColor;
+
+struct Material {
+    sampler2D texture_diffuse1;
+    sampler2D texture_specular1;
+#if NORMAL_MAP
+    sampler2D texture_normal1;
+#endif
+};
+
+struct DirLight {
+    vec3 direction;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+struct PointLight {
+    vec3 position;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+	
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+struct SpotLight {
+    vec3 position;  
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+	
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+// explicit locations, SPIR-V has no names to match them by
+layout (location = 0) in vec3 FragPos;
+layout (location = 1) in vec3 Normal;
+layout (location = 2) in vec2 TexCoords;
+#if NORMAL_MAP
+layout (location = 3) in mat3 TBN;
+#endif
+layout (location = 6) flat in vec3 ViewPos;  // camera of the view being drawn
+
+// the samplers take locations 3 to 5, see MULTILIGHT_UNIFORM_LOCATIONS in include/shadervariants.h
+layout (location = 3) uniform Material material;
+
+// lights shared by all views, see LightingBlock in include/uniformbuffers.h
+#define NR_POINT_LIGHTS 4
+layout (std140, binding = 2) uniform LightingBlock {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+    float shininess;
+};
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+
+void main() {
+    vec4 texColor = texture(material.texture_diffuse1, TexCoords);
+    if (ALPHA_TEST != 0 && texColor.a < 0.4) discard;
+
+#if NORMAL_MAP
+    // only xy are read, BC5 normal maps don't store z
+    vec2 xy = texture(material.texture_normal1, TexCoords).rg * 2.0 - 1.0;
+    vec3 norm = normalize(TBN * vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))));
+#else
+    vec3 norm = normalize(Normal);
+#endif
+
+    if (ALPHA_TEST != 0 && !gl_FrontFacing) {
+        norm = -norm;
+    }
+
+    vec3 viewDir = normalize(ViewPos - FragPos);
+
+    vec3 result = vec3(0.0);
+    if (DIR_LIGHT != 0) {
+        result += CalcDirLight(dirLight, norm, viewDir);
+    }
+
+    for (int i = 0; i < POINT_LIGHT_COUNT; i++) {
+        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+    }
+
+    if (SPOT_LIGHT != 0) {
+        result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
+    }
+
+    FragColor = vec4(result, ALPHA_TEST != 0 ? texColor.a : 1.0);
+}
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir) {
+    vec3 lightDir = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    // combine results
+    vec3 ambient = light.ambient * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 diffuse = light.diffuse * diff * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 specular = light.specular * spec * vec3(texture(material.texture_specular1, TexCoords));
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // combine results
+    vec3 ambient = light.ambient * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 diffuse = light.diffuse * diff * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 specular = light.specular * spec * vec3(texture(material.texture_specular1, TexCoords));
+    ambient *= attenuation;
+    diffuse *= attenuation;
+    specular *= attenuation;
+    return (ambient + diffuse + specular);
+}
+
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    vec3 ambient = light.ambient * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 diffuse = light.diffuse * diff * vec3(texture(material.texture_diffuse1, TexCoords));
+    vec3 specular = light.specular * spec * vec3(texture(material.texture_specular1, TexCoords));
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+})SHADER"},
+    {"shaders/multilight.vs", R"SHADER(#version 460 core
+// gl_Layer and gl_ViewportIndex from the vertex shader for MULTI_VIEW, see LayeredFramebuffer in include/layeredframebuffer.h
+#extension GL_ARB_shader_viewport_layer_array : enable
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
+
+// INSTANCED reads the model and normal matrices of gl_InstanceID from InstanceBlock instead of the model uniform,
+// MULTI_DRAW only changes multilight_packed.vs, it's declared here so both stages take the same constants.
+// MULTI_VIEW draws every camera of MultiViewBlock in one pass: each instance is repeated per view, the view is
+// gl_InstanceID % viewCount and goes to the layer and viewport of the same index.
+// #defines from ShaderVariants or specialization constants in SPIR-V like the variant values of multilight.fs
+#ifdef GL_SPIRV
+layout (constant_id = 4) const int INSTANCED = 0;
+layout (constant_id = 5) const int MULTI_DRAW = 0;
+layout (constant_id = 6) const int MULTI_VIEW = 0;
+#else
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+#ifndef MULTI_DRAW
+#define MULTI_DRAW 0
+#endif
+#ifndef MULTI_VIEW
+#define MULTI_VIEW 0
+#endif
+// without the extension gl_Layer can't be written and every view would land in layer 0
+#if MULTI_VIEW && !defined(GL_ARB_shader_viewport_layer_array)
+#error MULTI_VIEW needs GL_ARB_shader_viewport_layer_array
+#endif
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+
+// explicit locations, SPIR-V has no names to match them by
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec3 Normal;
+layout (location = 2) out vec2 TexCoords;
+#if NORMAL_MAP
+layout (location = 3) out mat3 TBN;
+#endif
+layout (location = 6) flat out vec3 ViewPos;
+
+layout (location = 0) uniform mat4 model;
+
+// per instance transforms, see InstanceData in include/instancebuffer.h
+struct Instance {
+    mat4 model;
+    mat3 normalMatrix;  // transpose(inverse(mat3(model))), computed once per instance on the CPU
+};
+layout (std430, binding = 0) readonly buffer InstanceBlock {
+    Instance instances[];
+};
+
+// camera of the view being drawn, see ViewBlock in include/uniformbuffers.h
+layout (std140, binding = 1) uniform ViewBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+// every camera of a multi-view pass, see MultiViewBlock in include/uniformbuffers.h
+#define MAX_MULTI_VIEWS 8
+struct View {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+layout (std140, binding = 3) uniform MultiViewBlock {
+    View views[MAX_MULTI_VIEWS];
+    int viewCount;
+};
+
+void main()
+{
+    int viewIndex = 0, instance = gl_InstanceID;
+    if (MULTI_VIEW != 0) {
+        viewIndex = gl_InstanceID % viewCount;
+        instance = gl_InstanceID / viewCount;
+    }
+
+    mat4 transform = model;
+    mat3 normalMatrix;
+    if (INSTANCED != 0) {
+        transform = instances[instance].model;
+        normalMatrix = instances[instance].normalMatrix;
+    } else {
+        normalMatrix = mat3(transpose(inverse(transform)));
+    }
+    FragPos = vec3(transform * vec4(aPos, 1.0));
+    Normal = normalMatrix * aNormal;
+    TexCoords = aTexCoords;
+#if NORMAL_MAP
+    TBN = mat3(normalize(mat3(transform) * aTangent), normalize(mat3(transform) * aBitangent), normalize(Normal));
+#endif
+
+    if (MULTI_VIEW != 0) {
+        gl_Position = views[viewIndex].projection * views[viewIndex].view * vec4(FragPos, 1.0);
+        ViewPos = views[viewIndex].viewPos;
+#ifdef GL_ARB_shader_viewport_layer_array
+        gl_Layer = viewIndex;
+        // each view has its own viewport, dynamic resolution draws them at different sizes
+        gl_ViewportIndex = viewIndex;
+#endif
+    } else {
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+        ViewPos = viewPos;
+    }
+})SHADER"},
+    {"shaders/multilight_packed.vs", R"SHADER(#version 460 core
+// gl_Layer and gl_ViewportIndex from the vertex shader for MULTI_VIEW, see LayeredFramebuffer in include/layeredframebuffer.h
+#extension GL_ARB_shader_viewport_layer_array : enable
+// multilight.vs for meshes uploaded with VERTEX_FORMAT_PACKED, see include/vertexpack.h
+layout (location = 0) in vec3 aPos;       // snorm16 in the mesh bounds
+layout (location = 1) in vec2 aNormal;    // octahedral snorm16
+layout (location = 2) in vec2 aTexCoords; // half floats, already expanded by the vertex fetch
+layout (location = 3) in vec4 aQTangent;  // snorm16 quaternion, w < 0 flips the bitangent
+
+// INSTANCED reads the model and normal matrices of gl_InstanceID from InstanceBlock instead of the model uniform,
+// MULTI_DRAW the mesh bounds of the draw from MeshBlock instead of the positionScale and positionOffset uniforms.
+// MULTI_VIEW draws every camera of MultiViewBlock in one pass: each instance is repeated per view, the view is
+// gl_InstanceID % viewCount and goes to the layer and viewport of the same index.
+// #defines from ShaderVariants or specialization constants in SPIR-V like the variant values of multilight.fs
+#ifdef GL_SPIRV
+layout (constant_id = 4) const int INSTANCED = 0;
+layout (constant_id = 5) const int MULTI_DRAW = 0;
+layout (constant_id = 6) const int MULTI_VIEW = 0;
+#else
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+#ifndef MULTI_DRAW
+#define MULTI_DRAW 0
+#endif
+#ifndef MULTI_VIEW
+#define MULTI_VIEW 0
+#endif
+// without the extension gl_Layer can't be written and every view would land in layer 0
+#if MULTI_VIEW && !defined(GL_ARB_shader_viewport_layer_array)
+#error MULTI_VIEW needs GL_ARB_shader_viewport_layer_array
+#endif
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+
+// explicit locations, SPIR-V has no names to match them by
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec3 Normal;
+layout (location = 2) out vec2 TexCoords;
+#if NORMAL_MAP
+layout (location = 3) out mat3 TBN;
+#endif
+layout (location = 6) flat out vec3 ViewPos;
+
+layout (location = 0) uniform mat4 model;
+
+// per instance transforms, see InstanceData in include/instancebuffer.h
+struct Instance {
+    mat4 model;
+    mat3 normalMatrix;  // transpose(inverse(mat3(model))), computed once per instance on the CPU
+};
+layout (std430, binding = 0) readonly buffer InstanceBlock {
+    Instance instances[];
+};
+
+// camera of the view being drawn, see ViewBlock in include/uniformbuffers.h
+layout (std140, binding = 1) uniform ViewBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+// every camera of a multi-view pass, see MultiViewBlock in include/uniformbuffers.h
+#define MAX_MULTI_VIEWS 8
+struct View {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+layout (std140, binding = 3) uniform MultiViewBlock {
+    View views[MAX_MULTI_VIEWS];
+    int viewCount;
+};
+
+layout (location = 1) uniform vec3 positionScale;
+layout (location = 2) uniform vec3 positionOffset;
+
+// bounds of every mesh in a MeshBuffer, a multi-draw points gl_BaseInstance at the one of each draw. see include/meshbuffer.h
+struct MeshBounds {
+    vec4 scale;  // xyz
+    vec4 offset;
+};
+layout (std430, binding = 1) readonly buffer MeshBlock {
+    MeshBounds meshBounds[];
+};
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// tangent frame from a QTangent, used by the NORMAL_MAP variant
+mat3 qtangentToTBN(vec4 q)
+{
+    q = normalize(q);
+    vec3 tangent = vec3(1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y));
+    vec3 normal = vec3(2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+    vec3 bitangent = cross(normal, tangent) * (q.w < 0.0 ? -1.0 : 1.0);
+    return mat3(tangent, bitangent, normal);
+}
+
+void main()
+{
+    vec3 position;
+    if (MULTI_DRAW != 0)
+        position = aPos * meshBounds[gl_BaseInstance].scale.xyz + meshBounds[gl_BaseInstance].offset.xyz;
+    else
+        position = aPos * positionScale + positionOffset;
+    int viewIndex = 0, instance = gl_InstanceID;
+    if (MULTI_VIEW != 0) {
+        viewIndex = gl_InstanceID % viewCount;
+        instance = gl_InstanceID / viewCount;
+    }
+
+    mat4 transform = model;
+    mat3 normalMatrix;
+    if (INSTANCED != 0) {
+        transform = instances[instance].model;
+        normalMatrix = instances[instance].normalMatrix;
+    } else {
+        normalMatrix = mat3(transpose(inverse(transform)));
+    }
+    FragPos = vec3(transform * vec4(position, 1.0));
+    Normal = normalMatrix * octDecode(aNormal);
+    TexCoords = aTexCoords;
+#if NORMAL_MAP
+    mat3 tangentFrame = qtangentToTBN(aQTangent);
+    TBN = mat3(normalize(mat3(transform) * tangentFrame[0]), normalize(mat3(transform) * tangentFrame[1]), normalize(normalMatrix * tangentFrame[2]));
+#endif
+
+    if (MULTI_VIEW != 0) {
+        gl_Position = views[viewIndex].projection * views[viewIndex].view * vec4(FragPos, 1.0);
+        ViewPos = views[viewIndex].viewPos;
+#ifdef GL_ARB_shader_viewport_layer_array
+        gl_Layer = viewIndex;
+        // each view has its own viewport, dynamic resolution draws them at different sizes
+        gl_ViewportIndex = viewIndex;
+#endif
+    } else {
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+        ViewPos = viewPos;
+    }
+}
+)SHADER"},
+    {"shaders/singlecolor.fs", R"SHADER(#version 460 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+
+void main() {
+    FragColor = vec4(1.0, 0.0, 0.0, 1.0);
+}
+)SHADER"},
+    {"shaders/singlecolor.vs", R"SHADER(#version 460 core
+layout (location = 0) in vec3 aPos;
+
+out vec3 FragPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+})SHADER"},
+};
+
+#endif
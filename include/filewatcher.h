@@ -0,0 +1,135 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+// Watches the files of one directory (not its subdirectories) on a background thread and collects
+// the ones that were written, changedFiles() hands them out on the caller's thread.
+// Linux uses inotify, everywhere else the modification times are polled every POLL_INTERVAL.
+class FileWatcher {
+   public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{250};
+
+    explicit FileWatcher(const std::string &directory) : directory(directory) {
+#ifdef __linux__
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        // editors either rewrite the file or move a new one over it
+        if (fd >= 0 && inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            close(fd);
+            fd = -1;
+        }
+        if (fd < 0)
+            std::cout << "WARNING::FILEWATCHER::INOTIFY_FAILED " << directory << ", polling instead" << std::endl;
+#endif
+        worker = std::thread([this]() { run(); });
+    }
+
+    ~FileWatcher() {
+        stopping = true;
+        worker.join();
+#ifdef __linux__
+        if (fd >= 0)
+            close(fd);
+#endif
+    }
+
+    FileWatcher(const FileWatcher &) = delete;
+    FileWatcher &operator=(const FileWatcher &) = delete;
+
+    // paths ("directory/name") written since the last call, each reported once
+    std::vector<std::string> changedFiles() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::string> files(changed.begin(), changed.end());
+        changed.clear();
+        return files;
+    }
+
+   private:
+    std::string directory;
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    std::mutex mutex;
+    std::unordered_set<std::string> changed;
+#ifdef __linux__
+    int fd = -1;
+#endif
+
+    void report(const std::string &name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.insert(directory + "/" + name);
+    }
+
+    void run() {
+#ifdef __linux__
+        if (fd >= 0) {
+            runInotify();
+            return;
+        }
+#endif
+        runPolling();
+    }
+
+#ifdef __linux__
+    void runInotify() {
+        alignas(inotify_event) char buffer[4096];
+        while (!stopping) {
+            // wake up now and then to notice the destructor
+            pollfd request = {fd, POLLIN, 0};
+            if (poll(&request, 1, (int)POLL_INTERVAL.count()) <= 0)
+                continue;
+            ssize_t length;
+            while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+                for (char *event = buffer; event < buffer + length;) {
+                    const inotify_event *info = (const inotify_event *)event;
+                    if (info->len > 0)
+                        report(info->name);
+                    event += sizeof(inotify_event) + info->len;
+                }
+            }
+        }
+    }
+#endif
+
+    void runPolling() {
+        std::unordered_map<std::string, std::filesystem::file_time_type> times;
+        bool first = true;
+        while (!stopping) {
+            std::error_code error;
+            for (const auto &entry : std::filesystem::directory_iterator(directory, error)) {
+                if (!entry.is_regular_file(error))
+                    continue;
+                std::string name = entry.path().filename().string();
+                std::filesystem::file_time_type time = entry.last_write_time(error);
+                auto it = times.find(name);
+                if (it == times.end()) {
+                    times.emplace(name, time);
+                    // files that show up later count as written, the ones present at the start don't
+                    if (!first)
+                        report(name);
+                } else if (it->second != time) {
+                    it->second = time;
+                    report(name);
+                }
+            }
+            first = false;
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef GLFWTERMINATOR_H
+#define GLFWTERMINATOR_H
+
+// include after GLFW/glfw3.h, so GLFW_DLL and the rest of the including file's GLFW setup apply
+#include <GLFW/glfw3.h>
+
+// Calls glfwTerminate when it goes out of scope. Models, meshes, shaders and uniform buffers delete their GL objects
+// in their destructors and need the context until then, so declare it before them in main: locals are destroyed in
+// reverse order and it goes last.
+class GlfwTerminator {
+   public:
+    GlfwTerminator() {}
+
+    ~GlfwTerminator() {
+        glfwTerminate();
+    }
+
+    GlfwTerminator(const GlfwTerminator &) = delete;
+    GlfwTerminator &operator=(const GlfwTerminator &) = delete;
+};
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <unordered_map>
+
+// kinds of state calls, for the counters
+enum GLStateCall {
+    GL_STATE_PROGRAM,
+    GL_STATE_VERTEX_ARRAY,
+    GL_STATE_TEXTURE,         // glBindTexture
+    GL_STATE_ACTIVE_TEXTURE,  // glActiveTexture
+    GL_STATE_CAPABILITY,      // glEnable / glDisable
+    GL_STATE_FIXED_FUNCTION,  // depth, stencil and blend functions and masks
+    GL_STATE_FRAMEBUFFER,
+    GL_STATE_CALL_KINDS
+};
+
+struct GLStateStats {
+    unsigned int issued[GL_STATE_CALL_KINDS] = {};    // calls that reached GL
+    unsigned int filtered[GL_STATE_CALL_KINDS] = {};  // calls dropped because GL was already in that state
+    unsigned int draws = 0;                           // draw calls, a multi-draw counts once
+
+    unsigned int totalIssued() const {
+        unsigned int total = 0;
+        for (unsigned int count : issued)
+            total += count;
+        return total;
+    }
+    unsigned int totalFiltered() const {
+        unsigned int total = 0;
+        for (unsigned int count : filtered)
+            total += count;
+        return total;
+    }
+};
+
+// Shadow copy of the GL state that changes between draws: program, vertex array, textures per unit, enabled
+// capabilities, depth/stencil/blend functions and the framebuffer. Setters that wouldn't change anything never
+// reach GL. Nothing is known at the start, so the first call of each kind always goes through. Code that changes
+// this state with plain GL calls afterwards has to call invalidate(), and deleted objects have to be forgotten
+// because GL hands their names out again. Only used from the GL thread.
+class GLState {
+   public:
+    static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+    static GLState &shared() {
+        static GLState state;
+        return state;
+    }
+
+    void useProgram(unsigned int program) {
+        if (set(program_, program, GL_STATE_PROGRAM))
+            glUseProgram(program);
+    }
+
+    void bindVertexArray(unsigned int vao) {
+        if (set(vertexArray, vao, GL_STATE_VERTEX_ARRAY))
+            glBindVertexArray(vao);
+    }
+
+    // binds a 2D texture to unit, switches the active unit only when the binding changes
+    void bindTextureUnit(unsigned int unit, unsigned int texture) {
+        if (unit >= MAX_TEXTURE_UNITS) {
+            activeTexture(unit);
+            glBindTexture(GL_TEXTURE_2D, texture);
+            count(GL_STATE_TEXTURE, true);
+            return;
+        }
+        if (!set(textures[unit], texture, GL_STATE_TEXTURE))
+            return;
+        activeTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+
+    // like glBindTexture(GL_TEXTURE_2D, texture) on the active unit, for code that creates and fills textures
+    void bindTexture(unsigned int texture) {
+        if (activeUnit == UNKNOWN || activeUnit >= MAX_TEXTURE_UNITS) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            count(GL_STATE_TEXTURE, true);
+            return;
+        }
+        bindTextureUnit(activeUnit, texture);
+    }
+
+    void setEnabled(GLenum capability, bool enabled) {
+        auto it = capabilities.find(capability);
+        bool changed = it == capabilities.end() || it->second != enabled;
+        count(GL_STATE_CAPABILITY, changed);
+        if (!changed)
+            return;
+        capabilities[capability] = enabled;
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+    void enable(GLenum capability) {
+        setEnabled(capability, true);
+    }
+    void disable(GLenum capability) {
+        setEnabled(capability, false);
+    }
+
+    void depthFunc(GLenum func) {
+        if (set(depth.func, func, GL_STATE_FIXED_FUNCTION))
+            glDepthFunc(func);
+    }
+    void depthMask(bool write) {
+        if (set(depth.mask, write ? 1u : 0u, GL_STATE_FIXED_FUNCTION))
+            glDepthMask(write ? GL_TRUE : GL_FALSE);
+    }
+    void stencilFunc(GLenum func, int ref, unsigned int mask) {
+        bool changed = set(stencil.func, func, GL_STATE_FIXED_FUNCTION, false) | set(stencil.ref, (unsigned int)ref, GL_STATE_FIXED_FUNCTION, false) |
+                       set(stencil.readMask, mask, GL_STATE_FIXED_FUNCTION, false);
+        count(GL_STATE_FIXED_FUNCTION, changed);
+        if (changed)
+            glStencilFunc(func, ref, mask);
+    }
+    void stencilOp(GLenum stencilFail, GLenum depthFail, GLenum depthPass) {
+        bool changed = set(stencil.fail, stencilFail, GL_STATE_FIXED_FUNCTION, false) | set(stencil.depthFail, depthFail, GL_STATE_FIXED_FUNCTION, false) |
+                       set(stencil.depthPass, depthPass, GL_STATE_FIXED_FUNCTION, false);
+        count(GL_STATE_FIXED_FUNCTION, changed);
+        if (changed)
+            glStencilOp(stencilFail, depthFail, depthPass);
+    }
+    void stencilMask(unsigned int mask) {
+        if (set(stencil.writeMask, mask, GL_STATE_FIXED_FUNCTION))
+            glStencilMask(mask);
+    }
+    void blendFunc(GLenum source, GLenum destination) {
+        bool changed = set(blend.source, source, GL_STATE_FIXED_FUNCTION, false) | set(blend.destination, destination, GL_STATE_FIXED_FUNCTION, false);
+        count(GL_STATE_FIXED_FUNCTION, changed);
+        if (changed)
+            glBlendFunc(source, destination);
+    }
+
+    // binds fbo for drawing and reading (GL_FRAMEBUFFER)
+    void bindFramebuffer(unsigned int fbo) {
+        if (set(framebuffer, fbo, GL_STATE_FRAMEBUFFER))
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    }
+
+    // draw calls aren't state, they're counted next to it so the stats show what the state changes bought
+    void countDraws(unsigned int count = 1) {
+        current.draws += count;
+    }
+
+    // forget everything, after GL calls that went around this
+    void invalidate() {
+        program_ = vertexArray = framebuffer = activeUnit = UNKNOWN;
+        for (unsigned int &texture : textures)
+            texture = UNKNOWN;
+        capabilities.clear();
+        depth = DepthState();
+        stencil = StencilState();
+        blend = BlendState();
+    }
+
+    // call before deleting objects that may be bound, so a new object with the same name gets bound for real
+    void forgetProgram(unsigned int program) {
+        if (program_ == program)
+            program_ = UNKNOWN;
+    }
+    void forgetVertexArray(unsigned int vao) {
+        if (vertexArray == vao)
+            vertexArray = UNKNOWN;
+    }
+    void forgetTexture(unsigned int texture) {
+        for (unsigned int &bound : textures) {
+            if (bound == texture)
+                bound = UNKNOWN;
+        }
+    }
+    void forgetFramebuffer(unsigned int fbo) {
+        if (framebuffer == fbo)
+            framebuffer = UNKNOWN;
+    }
+
+    // counters since the last endFrame(), and those of the frame before it
+    const GLStateStats &stats() const {
+        return current;
+    }
+    const GLStateStats &lastFrameStats() const {
+        return lastFrame;
+    }
+
+    void endFrame() {
+        lastFrame = current;
+        current = GLStateStats();
+    }
+
+    void printStats() const {
+        static const char *const NAMES[GL_STATE_CALL_KINDS] = {"program", "vertex array", "texture", "active texture", "enable/disable", "depth/stencil/blend", "framebuffer"};
+        std::cout << "gl state, last frame: " << lastFrame.draws << " draws, " << lastFrame.totalIssued() << " state calls issued, " << lastFrame.totalFiltered()
+                  << " filtered" << std::endl;
+        for (int kind = 0; kind < GL_STATE_CALL_KINDS; kind++) {
+            if (lastFrame.issued[kind] + lastFrame.filtered[kind] > 0)
+                std::cout << "  " << NAMES[kind] << ": " << lastFrame.issued[kind] << " issued, " << lastFrame.filtered[kind] << " filtered" << std::endl;
+        }
+    }
+
+   private:
+    static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+
+    struct DepthState {
+        unsigned int func = UNKNOWN, mask = UNKNOWN;
+    };
+    struct StencilState {
+        unsigned int func = UNKNOWN, ref = UNKNOWN, readMask = UNKNOWN, writeMask = UNKNOWN;
+        unsigned int fail = UNKNOWN, depthFail = UNKNOWN, depthPass = UNKNOWN;
+    };
+    struct BlendState {
+        unsigned int source = UNKNOWN, destination = UNKNOWN;
+    };
+
+    unsigned int program_ = UNKNOWN, vertexArray = UNKNOWN, framebuffer = UNKNOWN, activeUnit = UNKNOWN;
+    unsigned int textures[MAX_TEXTURE_UNITS];
+    std::unordered_map<GLenum, bool> capabilities;
+    DepthState depth;
+    StencilState stencil;
+    BlendState blend;
+    GLStateStats current, lastFrame;
+
+    GLState() {
+        invalidate();
+    }
+
+    void activeTexture(unsigned int unit) {
+        if (set(activeUnit, unit, GL_STATE_ACTIVE_TEXTURE))
+            glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    // stores value, true when it differs from what was there. counts the call unless counted is false
+    bool set(unsigned int &shadow, unsigned int value, GLStateCall kind, bool counted = true) {
+        bool changed = shadow != value;
+        shadow = value;
+        if (counted)
+            count(kind, changed);
+        return changed;
+    }
+
+    void count(GLStateCall kind, bool issued) {
+        if (issued)
+            current.issued[kind]++;
+        else
+            current.filtered[kind]++;
+    }
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 64-bit FNV-1a, usable at compile time for string literals
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+constexpr uint64_t hashString(const char *str, uint64_t hash = FNV_OFFSET_BASIS) {
+    while (*str)
+        hash = (hash ^ (uint64_t)(unsigned char)*str++) * FNV_PRIME;
+    return hash;
+}
+
+inline uint64_t hashString(const std::string &str, uint64_t hash = FNV_OFFSET_BASIS) {
+    for (unsigned char c : str)
+        hash = (hash ^ c) * FNV_PRIME;
+    return hash;
+}
+
+// mixes a 64-bit value so that nearby inputs end up far apart (splitmix64 finalizer)
+inline uint64_t hashMix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    return hashMix(seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2)));
+}
+
+// hashes a block of memory 8 bytes at a time, fast enough to run over whole model files
+inline uint64_t hashBytes(const void *data, size_t size, uint64_t seed = FNV_OFFSET_BASIS) {
+    const unsigned char *bytes = (const unsigned char *)data;
+    uint64_t hash = seed ^ (size * FNV_PRIME);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, 8);
+        hash = (hash ^ hashMix(word)) * FNV_PRIME;
+    }
+    uint64_t tail = 0;
+    for (size_t shift = 0; i < size; i++, shift += 8)
+        tail |= (uint64_t)bytes[i] << shift;
+    return hashMix(hash ^ tail);
+}
+
+#endif
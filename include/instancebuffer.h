@@ -0,0 +1,93 @@
+#ifndef INSTANCEBUFFER_H
+#define INSTANCEBUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include <vector>
+
+// shader storage binding of InstanceBlock, fixed in the multilight vertex shaders with layout (std430, binding = N)
+const unsigned int INSTANCE_BLOCK_BINDING = 0;
+
+// one element of InstanceBlock. std430 lays a mat3 out as three vec4 columns, which is what mat3x4 is in glm
+struct InstanceData {
+    glm::mat4 model;
+    glm::mat3x4 normalMatrix;
+};
+static_assert(sizeof(InstanceData) == 112, "InstanceData must match the std430 layout");
+
+// Per instance transforms for Model::DrawInstanced, in a shader storage buffer. The normal matrix of every
+// instance is computed here once instead of per vertex. Upload once for props that don't move, or again
+// whenever the transforms change. the context has to outlive it
+class InstanceBuffer {
+   public:
+    InstanceBuffer() {
+        glGenBuffers(1, &SSBO);
+    }
+    explicit InstanceBuffer(const std::vector<glm::mat4> &models) : InstanceBuffer() {
+        upload(models);
+    }
+
+    InstanceBuffer(const InstanceBuffer &) = delete;
+    InstanceBuffer &operator=(const InstanceBuffer &) = delete;
+
+    ~InstanceBuffer() {
+        glDeleteBuffers(1, &SSBO);
+    }
+
+    // replaces the instances with these model matrices
+    void upload(const glm::mat4 *models, size_t count) {
+        staging.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            staging[i].model = models[i];
+            staging[i].normalMatrix = glm::mat3x4(glm::transpose(glm::inverse(glm::mat3(models[i]))));
+        }
+        instanceCount = count;
+        meanModel = glm::mat4(0.0f);
+        for (size_t i = 0; i < count; i++)
+            meanModel += models[i] / (float)count;
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, SSBO);
+        if (count > capacity) {
+            // grow geometrically so instances added a few at a time don't reallocate every upload
+            capacity = count > capacity * 2 ? count : capacity * 2;
+            glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(InstanceData), NULL, GL_DYNAMIC_DRAW);
+        } else if (capacity > 0) {
+            // orphan the storage, so a draw still reading the old transforms doesn't stall the upload
+            glInvalidateBufferData(SSBO);
+        }
+        if (count > 0)
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, count * sizeof(InstanceData), staging.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+    void upload(const std::vector<glm::mat4> &models) {
+        upload(models.data(), models.size());
+    }
+
+    // points InstanceBlock at these instances
+    void bind() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_BLOCK_BINDING, SSBO);
+    }
+
+    size_t size() const {
+        return instanceCount;
+    }
+
+    const glm::mat4 &model(size_t instance) const {
+        return staging[instance].model;
+    }
+
+    // the average of the model matrices, it moves a point to the average of where the instances put it
+    const glm::mat4 &averageModel() const {
+        return meanModel;
+    }
+
+   private:
+    unsigned int SSBO = 0;
+    size_t instanceCount = 0, capacity = 0;
+    std::vector<InstanceData> staging;
+    glm::mat4 meanModel = glm::mat4(0.0f);
+};
+
+#endif
@@ -0,0 +1,266 @@
+#ifndef KTX2_H
+#define KTX2_H
+
+#include <bcencode.h>
+#include <glad/glad.h>
+#include <glstate.h>
+#include <mappedfile.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// block compressed formats of GL_EXT_texture_compression_s3tc / _sRGB, not part of the core profile headers
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// Minimal KTX 2.0 support: a single 2D image with a full mip chain of one block compressed format,
+// no supercompression. https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+// VkFormat values of the formats we write
+enum Ktx2VkFormat {
+    VK_FORMAT_BC1_RGB_UNORM_BLOCK = 131,
+    VK_FORMAT_BC1_RGB_SRGB_BLOCK = 132,
+    VK_FORMAT_BC3_UNORM_BLOCK = 137,
+    VK_FORMAT_BC3_SRGB_BLOCK = 138,
+    VK_FORMAT_BC5_UNORM_BLOCK = 141,
+    VK_FORMAT_BC7_UNORM_BLOCK = 145,
+    VK_FORMAT_BC7_SRGB_BLOCK = 146
+};
+
+struct Ktx2Header {
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+inline uint32_t ktx2VkFormat(BlockFormat format, bool srgb) {
+    switch (format) {
+        case BLOCK_BC1:
+            return srgb ? VK_FORMAT_BC1_RGB_SRGB_BLOCK : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case BLOCK_BC3:
+            return srgb ? VK_FORMAT_BC3_SRGB_BLOCK : VK_FORMAT_BC3_UNORM_BLOCK;
+        case BLOCK_BC5:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case BLOCK_BC7:
+            return srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+    return 0;
+}
+
+// GL internal format for a VkFormat, 0 if we can't upload it
+inline GLenum ktx2GLFormat(uint32_t vkFormat) {
+    switch (vkFormat) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+            return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            return GL_COMPRESSED_RG_RGTC2;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+    }
+    return 0;
+}
+
+// the compressed file that belongs to an image: same name with a .ktx2 extension
+inline std::string ktx2PathFor(const std::string &imagePath) {
+    size_t dot = imagePath.find_last_of('.');
+    size_t slash = imagePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return imagePath + ".ktx2";
+    return imagePath.substr(0, dot) + ".ktx2";
+}
+
+// Data Format Descriptor with one basic block describing the BC format
+inline std::vector<uint32_t> ktx2DataFormatDescriptor(BlockFormat format, bool srgb) {
+    // KHR_DF_MODEL_BC1A, BC3, BC5, BC7
+    uint32_t model = format == BLOCK_BC1 ? 128 : format == BLOCK_BC3 ? 130 : format == BLOCK_BC5 ? 132 : 134;
+    // (channel id, bit offset) per 64/128 bit sample
+    std::vector<std::pair<uint32_t, uint32_t>> samples;
+    if (format == BLOCK_BC1 || format == BLOCK_BC7)
+        samples.push_back({0, 0});
+    else if (format == BLOCK_BC3)
+        samples = {{15, 0}, {0, 64}};  // alpha block, then color block
+    else
+        samples = {{0, 0}, {1, 64}};  // red block, then green block
+    uint32_t sampleBits = format == BLOCK_BC7 ? 128 : 64;
+
+    uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);                          // dfdTotalSize
+    dfd.push_back(0);                                      // vendor id 0 (Khronos), descriptor type 0 (basic)
+    dfd.push_back(2 | (blockSize << 16));                  // version 2, block size
+    dfd.push_back(model | (1 << 8) | ((srgb ? 2 : 1) << 16));  // color model, BT709 primaries, transfer function, flags
+    dfd.push_back(3 | (3 << 8));                           // 4x4x1x1 texel block (stored as dimension - 1)
+    dfd.push_back((uint32_t)blockBytes(format));           // bytes in plane 0
+    dfd.push_back(0);                                      // planes 4..7
+    for (const auto &sample : samples) {
+        dfd.push_back(sample.second | ((sampleBits - 1) << 16) | (sample.first << 24));
+        dfd.push_back(0);           // sample position
+        dfd.push_back(0);           // sample lower
+        dfd.push_back(0xffffffff);  // sample upper
+    }
+    return dfd;
+}
+
+// writes the mip levels (level 0 first, each already compressed) into a KTX2 file
+inline bool writeKtx2(const std::string &path, BlockFormat format, bool srgb, int width, int height, const std::vector<std::vector<uint8_t>> &levels) {
+    std::vector<uint32_t> dfd = ktx2DataFormatDescriptor(format, srgb);
+    // our images are stored bottom row first like stbi with flipping enabled, so the origin is bottom left
+    std::vector<uint8_t> kvd;
+    auto addKeyValue = [&kvd](const std::string &key, const std::string &value) {
+        uint32_t length = (uint32_t)(key.size() + 1 + value.size() + 1);
+        kvd.insert(kvd.end(), (const uint8_t *)&length, (const uint8_t *)&length + 4);
+        kvd.insert(kvd.end(), key.begin(), key.end());
+        kvd.push_back(0);
+        kvd.insert(kvd.end(), value.begin(), value.end());
+        kvd.push_back(0);
+        while (kvd.size() % 4)
+            kvd.push_back(0);
+    };
+    addKeyValue("KTXorientation", "ru");
+    addKeyValue("KTXwriter", "OpenGL-Playground ktxencode");
+
+    Ktx2Header header = {};
+    header.vkFormat = ktx2VkFormat(format, srgb);
+    header.typeSize = 1;
+    header.pixelWidth = (uint32_t)width;
+    header.pixelHeight = (uint32_t)height;
+    header.faceCount = 1;
+    header.levelCount = (uint32_t)levels.size();
+    header.dfdByteOffset = (uint32_t)(sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2LevelIndex));
+    header.dfdByteLength = (uint32_t)(dfd.size() * 4);
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = (uint32_t)kvd.size();
+
+    // level data goes smallest mip first, each level aligned to the block size
+    size_t alignment = blockBytes(format);
+    std::vector<Ktx2LevelIndex> index(levels.size());
+    uint64_t offset = header.kvdByteOffset + header.kvdByteLength;
+    for (size_t i = levels.size(); i-- > 0;) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        index[i].byteOffset = offset;
+        index[i].byteLength = levels[i].size();
+        index[i].uncompressedByteLength = levels[i].size();
+        offset += levels[i].size();
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        return false;
+    out.write((const char *)KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    out.write((const char *)&header, sizeof(header));
+    out.write((const char *)index.data(), index.size() * sizeof(Ktx2LevelIndex));
+    out.write((const char *)dfd.data(), dfd.size() * 4);
+    out.write((const char *)kvd.data(), kvd.size());
+    uint64_t written = header.kvdByteOffset + header.kvdByteLength;
+    for (size_t i = levels.size(); i-- > 0;) {
+        static const char padding[16] = {};
+        out.write(padding, (std::streamsize)(index[i].byteOffset - written));
+        out.write((const char *)levels[i].data(), levels[i].size());
+        written = index[i].byteOffset + levels[i].size();
+    }
+    return (bool)out;
+}
+
+// parsed view of a KTX2 file in memory, level pointers point into the caller's buffer
+struct Ktx2Image {
+    GLenum internalFormat = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<const uint8_t *> levels;
+    std::vector<size_t> levelSizes;
+};
+
+inline bool parseKtx2(const uint8_t *data, size_t size, Ktx2Image &image) {
+    if (size < sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header) || std::memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        return false;
+    Ktx2Header header;
+    std::memcpy(&header, data + sizeof(KTX2_IDENTIFIER), sizeof(header));
+    image.internalFormat = ktx2GLFormat(header.vkFormat);
+    if (image.internalFormat == 0 || header.supercompressionScheme != 0 || header.pixelDepth > 1 || header.layerCount > 1 ||
+        header.faceCount != 1 || header.levelCount == 0)
+        return false;
+    size_t indexOffset = sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header);
+    if (size < indexOffset + header.levelCount * sizeof(Ktx2LevelIndex))
+        return false;
+
+    image.width = (int)header.pixelWidth;
+    image.height = (int)header.pixelHeight;
+    image.levels.clear();
+    image.levelSizes.clear();
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        Ktx2LevelIndex level;
+        std::memcpy(&level, data + indexOffset + i * sizeof(Ktx2LevelIndex), sizeof(level));
+        if (level.byteOffset + level.byteLength > size)
+            return false;
+        image.levels.push_back(data + level.byteOffset);
+        image.levelSizes.push_back((size_t)level.byteLength);
+    }
+    return true;
+}
+
+// uploads every level of the image into the bound GL_TEXTURE_2D. With a pixel unpack buffer bound, the
+// level pointers are offsets relative to base instead.
+inline void uploadKtx2(const Ktx2Image &image, const uint8_t *base = nullptr) {
+    int levelCount = (int)image.levels.size();
+    for (int level = 0; level < levelCount; level++) {
+        int width = std::max(1, image.width >> level), height = std::max(1, image.height >> level);
+        const void *pixels = base ? (const void *)(image.levels[level] - base) : (const void *)image.levels[level];
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, image.internalFormat, width, height, 0, (GLsizei)image.levelSizes[level], pixels);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+}
+
+// loads a KTX2 file into the given texture, returns false if it's missing or unsupported
+inline bool loadKtx2Texture(const std::string &path, unsigned int textureID) {
+    MappedFile file(path);
+    Ktx2Image image;
+    if (!file.isOpen() || !parseKtx2(file.data(), file.size(), image))
+        return false;
+    GLState::shared().bindTexture(textureID);
+    uploadKtx2(image);
+    return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef LAYEREDFRAMEBUFFER_H
+#define LAYEREDFRAMEBUFFER_H
+
+#include <glad/glad.h>
+#include <glstate.h>
+
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// Render target for several views of the same size: a 2D array color texture and a depth/stencil array with one
+// layer per view. framebuffer() has every layer attached, a SHADER_MULTI_VIEW pass picks the layer of each view with
+// gl_Layer and draws all of them at once (see CommandList::replayMultiView). layerFramebuffer() has a single layer
+// attached, for drawing the views one after the other where the vertex shader can't write gl_Layer.
+// Created with the direct state access calls so the texture and framebuffer bindings GLState tracks stay untouched.
+// the context has to outlive it
+class LayeredFramebuffer {
+   public:
+    const int width, height, layers;
+
+    LayeredFramebuffer(int width, int height, int layers) : width(width), height(height), layers(layers), layerFbos(layers) {
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &colorArray);
+        glTextureStorage3D(colorArray, 1, GL_RGB8, width, height, layers);
+        glTextureParameteri(colorArray, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(colorArray, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(colorArray, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(colorArray, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &depthArray);
+        glTextureStorage3D(depthArray, 1, GL_DEPTH24_STENCIL8, width, height, layers);
+
+        glCreateFramebuffers(1, &layered);
+        glNamedFramebufferTexture(layered, GL_COLOR_ATTACHMENT0, colorArray, 0);
+        glNamedFramebufferTexture(layered, GL_DEPTH_STENCIL_ATTACHMENT, depthArray, 0);
+        checkComplete(layered);
+
+        glCreateFramebuffers(layers, layerFbos.data());
+        for (int layer = 0; layer < layers; layer++) {
+            glNamedFramebufferTextureLayer(layerFbos[layer], GL_COLOR_ATTACHMENT0, colorArray, 0, layer);
+            glNamedFramebufferTextureLayer(layerFbos[layer], GL_DEPTH_STENCIL_ATTACHMENT, depthArray, 0, layer);
+            checkComplete(layerFbos[layer]);
+        }
+    }
+
+    LayeredFramebuffer(const LayeredFramebuffer &) = delete;
+    LayeredFramebuffer &operator=(const LayeredFramebuffer &) = delete;
+
+    ~LayeredFramebuffer() {
+        GLState &state = GLState::shared();
+        state.forgetFramebuffer(layered);
+        for (unsigned int fbo : layerFbos)
+            state.forgetFramebuffer(fbo);
+        glDeleteFramebuffers(1, &layered);
+        glDeleteFramebuffers(layers, layerFbos.data());
+        unsigned int textures[] = {colorArray, depthArray};
+        glDeleteTextures(2, textures);
+    }
+
+    // every layer, clearing it clears all of them
+    unsigned int framebuffer() const {
+        return layered;
+    }
+
+    unsigned int layerFramebuffer(int layer) const {
+        return layerFbos[layer];
+    }
+
+    // the color array, for a sampler2DArray
+    unsigned int colorTexture() const {
+        return colorArray;
+    }
+
+    // whether a vertex shader can pick the layer and viewport (GL_ARB_shader_viewport_layer_array), which multi-view
+    // passes need
+    static bool layerFromVertexShader() {
+        static const bool supported = []() {
+            int count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (int i = 0; i < count; i++) {
+                const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+                if (extension && std::strcmp(extension, "GL_ARB_shader_viewport_layer_array") == 0)
+                    return true;
+            }
+            return false;
+        }();
+        return supported;
+    }
+
+   private:
+    unsigned int colorArray = 0, depthArray = 0, layered = 0;
+    std::vector<unsigned int> layerFbos;
+
+    static void checkComplete(unsigned int fbo) {
+        if (glCheckNamedFramebufferStatus(fbo, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::FRAMEBUFFER:: Layered framebuffer is not complete!" << std::endl;
+    }
+};
+
+#endif
@@ -2,7 +2,10 @@
 #define MESH_H
 
 #include <glad/glad.h>  // holds all OpenGL type declarations
+#include <glstate.h>
 #include <shader.h>
+#include <shaderuniforms.h>
+#include <vertexpack.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -23,40 +26,265 @@ struct Vertex {
     glm::vec3 Bitangent;
 };
 
+// how a Mesh stores its vertices on the GPU
+enum VertexFormat {
+    VERTEX_FORMAT_FLOAT,  // Vertex as is, 56 bytes
+    VERTEX_FORMAT_PACKED  // PackedVertex, 24 bytes, needs shaders/multilight_packed.vs
+};
+
+// meshes with at most this many vertices are drawn with GL_UNSIGNED_SHORT indices
+const size_t MAX_16BIT_VERTICES = 65536;
+// shaders a Mesh keeps resolved uniform locations for
+const size_t MAX_SHADER_BINDINGS = 8;
+
 struct Texture {
     unsigned int id;
     string type;
     string path;
 };
 
+// where a mesh lives inside buffers it shares with other meshes (see MeshBuffer), indices are relative to baseVertex
+struct MeshRange {
+    unsigned int VAO;
+    GLenum indexType;
+    size_t firstIndex;  // in indices, not bytes
+    int baseVertex;
+    size_t vertexCount, indexCount;
+    PackedBounds bounds;
+};
+
+// CPU side mesh data produced by the importers before anything touches the GL context
+struct MeshData {
+    vector<Vertex> vertices;
+    vector<unsigned int> indices;
+    vector<Texture> textures;  // type and path only, ids are filled in when the textures get loaded
+};
+
 class Mesh {
    public:
-    // mesh Data
+    // mesh Data, vertices and indices stay empty for meshes that only live on the GPU
     vector<Vertex> vertices;
     vector<unsigned int> indices;
     vector<Texture> textures;
-    unsigned int VAO;
-
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures) {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+    unsigned int VAO = 0;
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    VertexFormat format;
+    PackedBounds bounds;    // bounding box, offset is its center. also the dequantization of packed positions
+    GLenum indexType;       // GL_UNSIGNED_SHORT when the vertex count allows it, GL_UNSIGNED_INT otherwise
+    size_t firstIndex = 0;  // first index in the index buffer, non zero only for meshes in shared buffers
+    int baseVertex = 0;     // added to every index, likewise
 
+    // constructor, takes ownership of the arrays. with keepCpuData false they are freed once they're uploaded.
+    Mesh(vector<Vertex> &&vertices, vector<unsigned int> &&indices, vector<Texture> &&textures, VertexFormat format = VERTEX_FORMAT_FLOAT, bool keepCpuData = true)
+        : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)), format(format) {
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setupMesh();
+        setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+        if (!keepCpuData) {
+            vector<Vertex>().swap(this->vertices);
+            vector<unsigned int>().swap(this->indices);
+        }
+    }
+
+    // constructor for data that already sits in memory (e.g. a mapped mesh cache), uploads straight from the given arrays
+    Mesh(const Vertex *vertexData, size_t vertexCount, const unsigned int *indexData, size_t indexCount, vector<Texture> &&textures, VertexFormat format = VERTEX_FORMAT_FLOAT, bool keepCpuData = true)
+        : textures(std::move(textures)), format(format) {
+        if (keepCpuData) {
+            this->vertices.assign(vertexData, vertexData + vertexCount);
+            this->indices.assign(indexData, indexData + indexCount);
+        }
+        setupMesh(vertexData, vertexCount, indexData, indexCount);
+    }
+
+    // constructor for a mesh that was uploaded into shared buffers, which stay owned by whoever made them (see MeshBuffer).
+    // vertices and indices are only the CPU copies and may be left empty
+    Mesh(const MeshRange &range, vector<Texture> &&textures, VertexFormat format, vector<Vertex> &&vertices = {}, vector<unsigned int> &&indices = {})
+        : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)), VAO(range.VAO), vertexCount(range.vertexCount),
+          indexCount(range.indexCount), format(format), bounds(range.bounds), indexType(range.indexType), firstIndex(range.firstIndex),
+          baseVertex(range.baseVertex), sharedBuffers(true) {}
+
+    // a Mesh owns its GL objects, so it can be moved but not copied
+    Mesh(const Mesh &) = delete;
+    Mesh &operator=(const Mesh &) = delete;
+
+    Mesh(Mesh &&other) noexcept
+        : vertices(std::move(other.vertices)), indices(std::move(other.indices)), textures(std::move(other.textures)), VAO(other.VAO), vertexCount(other.vertexCount),
+          indexCount(other.indexCount), format(other.format), bounds(other.bounds), indexType(other.indexType), firstIndex(other.firstIndex),
+          baseVertex(other.baseVertex), VBO(other.VBO), EBO(other.EBO), sharedBuffers(other.sharedBuffers), shaderBindings(std::move(other.shaderBindings)), lastBindings(other.lastBindings) {
+        other.VAO = other.VBO = other.EBO = 0;
+    }
+
+    Mesh &operator=(Mesh &&other) noexcept {
+        if (this != &other) {
+            deleteBuffers();
+            vertices = std::move(other.vertices);
+            indices = std::move(other.indices);
+            textures = std::move(other.textures);
+            VAO = other.VAO;
+            VBO = other.VBO;
+            EBO = other.EBO;
+            vertexCount = other.vertexCount;
+            indexCount = other.indexCount;
+            format = other.format;
+            bounds = other.bounds;
+            indexType = other.indexType;
+            firstIndex = other.firstIndex;
+            baseVertex = other.baseVertex;
+            sharedBuffers = other.sharedBuffers;
+            shaderBindings = std::move(other.shaderBindings);
+            lastBindings = other.lastBindings;
+            other.VAO = other.VBO = other.EBO = 0;
+        }
+        return *this;
+    }
+
+    ~Mesh() {
+        deleteBuffers();
+    }
+
+    bool hasTexture(const string &type) const {
+        for (const Texture &texture : textures)
+            if (texture.type == type)
+                return true;
+        return false;
     }
 
     // render the mesh
     void Draw(Shader &shader) {
-        // bind appropriate textures
+        Bind(shader);
+        glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, indexType, indexOffset(), baseVertex);
+        GLState::shared().countDraws();
+    }
+
+    // render instanceCount copies in one draw, for shaders that place gl_InstanceID themselves (SHADER_INSTANCED)
+    void DrawInstanced(Shader &shader, size_t instanceCount) {
+        Bind(shader);
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indexCount, indexType, indexOffset(), (GLsizei)instanceCount, baseVertex);
+        GLState::shared().countDraws();
+    }
+
+    // textures, samplers, packed bounds and VAO of a draw with shader, for callers that issue the draw themselves
+    void Bind(Shader &shader) {
+        const ShaderBindings &bindings = bindingsFor(shader);
+        GLState &state = GLState::shared();
+        for (const SamplerBinding &sampler : bindings.samplers) {
+            // now set the sampler to the correct texture unit, a no-op once the program has that value
+            shader.setSampler(sampler.location, sampler.unit);
+            // and finally bind the texture, GLState switches the active unit only when it has to
+            state.bindTextureUnit(sampler.unit, textures[sampler.unit].id);
+        }
+
+        // packed positions are relative to the mesh bounds
+        if (format == VERTEX_FORMAT_PACKED) {
+            shader.set3f(bindings.positionScale, bounds.scale);
+            shader.set3f(bindings.positionOffset, bounds.offset);
+        }
+
+        // the VAO and texture units stay bound, the next draw only changes what differs
+        state.bindVertexArray(VAO);
+    }
+
+    // drops the uniform locations resolved for the shaders this was drawn with, needed after changing textures
+    void clearShaderBindings() {
+        shaderBindings.clear();
+    }
+
+    // the attribute layout of format, for the buffer bound to GL_ARRAY_BUFFER. locations 0-3 are the same in both
+    static void setupAttributes(VertexFormat format) {
+        if (format == VERTEX_FORMAT_PACKED) {
+            // vertex Positions (the padding short is skipped)
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, Position));
+            // octahedral normals
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, Normal));
+            // half float texture coords
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, TexCoords));
+            // QTangent, replaces tangent and bitangent
+            glEnableVertexAttribArray(3);
+            glVertexAttribPointer(3, 4, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void *)offsetof(PackedVertex, QTangent));
+            return;
+        }
+        // vertex Positions
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
+        // vertex normals
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
+        // vertex texture coords
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
+        // vertex tangent
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Tangent));
+        // vertex bitangent
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Bitangent));
+    }
+
+    // the dequantization that fits the positions into snorm16
+    static PackedBounds packedBounds(const Vertex *vertexData, size_t vertexCount) {
+        glm::vec3 min(0.0f), max(0.0f);
+        if (vertexCount > 0)
+            min = max = vertexData[0].Position;
+        for (size_t i = 1; i < vertexCount; i++) {
+            min = glm::min(min, vertexData[i].Position);
+            max = glm::max(max, vertexData[i].Position);
+        }
+        return PackedBounds::fromRange(min, max);
+    }
+
+    // the vertices as PackedVertex relative to bounds
+    static void packVertices(const Vertex *vertexData, size_t vertexCount, const PackedBounds &bounds, PackedVertex *packed) {
+        for (size_t i = 0; i < vertexCount; i++) {
+            const Vertex &vertex = vertexData[i];
+            packed[i] = packVertex(vertex.Position, vertex.Normal, vertex.TexCoords, vertex.Tangent, vertex.Bitangent, bounds);
+        }
+    }
+
+   private:
+    // render data
+    unsigned int VBO = 0, EBO = 0;
+    bool sharedBuffers = false;  // the VAO and buffers belong to a MeshBuffer
+
+    const void *indexOffset() const {
+        return (const void *)(firstIndex * (indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(unsigned int)));
+    }
+
+    // texture i goes to unit i, location is its sampler uniform in one shader (-1 when the shader doesn't sample it)
+    struct SamplerBinding {
+        int location;
+        unsigned int unit;
+    };
+    // what Draw needs from a shader, resolved on the first draw with it
+    struct ShaderBindings {
+        uint64_t shader;  // Shader::serial
+        vector<SamplerBinding> samplers;
+        int positionScale, positionOffset;
+    };
+    vector<ShaderBindings> shaderBindings;  // a handful at most: the variant the mesh is drawn with, outline shaders...
+    size_t lastBindings = 0;
+
+    const ShaderBindings &bindingsFor(const Shader &shader) {
+        if (lastBindings < shaderBindings.size() && shaderBindings[lastBindings].shader == shader.serial)
+            return shaderBindings[lastBindings];
+        for (size_t i = 0; i < shaderBindings.size(); i++) {
+            if (shaderBindings[i].shader == shader.serial) {
+                lastBindings = i;
+                return shaderBindings[i];
+            }
+        }
+
+        // sampler names follow the material.texture_diffuseN convention, N counting per type from 1
+        ShaderBindings bindings;
+        bindings.shader = shader.serial;
         unsigned int diffuseNr = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr = 1;
         unsigned int heightNr = 1;
         string prefix = "material.";
         for (unsigned int i = 0; i < textures.size(); i++) {
-            glActiveTexture(GL_TEXTURE0 + i);  // active proper texture unit before binding
             // retrieve texture number (the N in diffuse_textureN)
             string number;
             string name = textures[i].type;
@@ -68,62 +296,77 @@ class Mesh {
                 number = std::to_string(normalNr++);  // transfer unsigned int to stream
             else if (name == "texture_height")
                 number = std::to_string(heightNr++);  // transfer unsigned int to stream
-
-            // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (prefix + name + number).c_str()), i);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            bindings.samplers.push_back({shader.uniformLocation(prefix + name + number), i});
         }
+        bindings.positionScale = shader.uniformLocation(shaderuniforms::multilight_packed_vs::POSITION_SCALE);
+        bindings.positionOffset = shader.uniformLocation(shaderuniforms::multilight_packed_vs::POSITION_OFFSET);
 
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
+        // shaders that were deleted leave their entries behind, start over instead of growing without bound
+        if (shaderBindings.size() >= MAX_SHADER_BINDINGS)
+            shaderBindings.clear();
+        shaderBindings.push_back(std::move(bindings));
+        lastBindings = shaderBindings.size() - 1;
+        return shaderBindings.back();
     }
 
-   private:
-    // render data
-    unsigned int VBO, EBO;
+    void deleteBuffers() {
+        if (VAO == 0 || sharedBuffers)
+            return;
+        GLState::shared().forgetVertexArray(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = VBO = EBO = 0;
+    }
 
     // initializes all the buffer objects/arrays
-    void setupMesh() {
+    void setupMesh(const Vertex *vertexData, size_t vertexCount, const unsigned int *indexData, size_t indexCount) {
+        this->vertexCount = vertexCount;
+        this->indexCount = indexCount;
+
         // create buffers/arrays
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
-        glBindVertexArray(VAO);
-        // load data into vertex buffers
+        GLState::shared().bindVertexArray(VAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        if (vertexCount <= MAX_16BIT_VERTICES) {
+            // every index fits in 16 bits, which halves the index buffer
+            vector<uint16_t> shortIndices(indexData, indexData + indexCount);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_SHORT;
+        } else {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
+            indexType = GL_UNSIGNED_INT;
+        }
+
+        // load data into vertex buffers and set the vertex attribute pointers
+        bounds = packedBounds(vertexData, vertexCount);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        if (format == VERTEX_FORMAT_PACKED)
+            setupPackedVertices(vertexData, vertexCount);
+        else
+            setupFloatVertices(vertexData, vertexCount);
+
+        // unbound so later GL_ELEMENT_ARRAY_BUFFER binds can't change this VAO
+        GLState::shared().bindVertexArray(0);
+    }
+
+    void setupFloatVertices(const Vertex *vertexData, size_t vertexCount) {
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-        // set the vertex attribute pointers
-        // vertex Positions
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)0);
-        // vertex normals
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Normal));
-        // vertex texture coords
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, TexCoords));
-        // vertex tangent
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Tangent));
-        // vertex bitangent
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, Bitangent));
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);
+        setupAttributes(VERTEX_FORMAT_FLOAT);
+    }
 
-        glBindVertexArray(0);
+    // quantizes the vertices relative to bounds into the bound VBO and sets up the matching attributes
+    void setupPackedVertices(const Vertex *vertexData, size_t vertexCount) {
+        vector<PackedVertex> packed(vertexCount);
+        packVertices(vertexData, vertexCount, bounds, packed.data());
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW);
+        setupAttributes(VERTEX_FORMAT_PACKED);
     }
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,178 @@
+#ifndef MESHBUFFER_H
+#define MESHBUFFER_H
+
+#include <glad/glad.h>
+#include <glstate.h>
+#include <mesh.h>
+#include <vertexpack.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <vector>
+
+// shader storage binding of MeshBlock, fixed in shaders/multilight_packed.vs with layout (std430, binding = N)
+const unsigned int MESH_BLOCK_BINDING = 1;
+
+// the command layout glMultiDrawElementsIndirect reads
+struct DrawElementsIndirectCommand {
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;  // the MeshBlock element of the draw, shaders read it as gl_BaseInstance
+};
+
+// one element of MeshBlock, the packed position bounds of a mesh. std430 pads vec3 to 16 bytes
+struct MeshBlockData {
+    glm::vec4 scale;
+    glm::vec4 offset;
+};
+static_assert(sizeof(MeshBlockData) == 32, "MeshBlockData must match the std430 layout");
+
+// The vertices and indices of many meshes in one immutable vertex buffer and one immutable index buffer
+// (glBufferStorage) behind a single VAO, so switching between them binds nothing and they can be submitted
+// together with glMultiDrawElementsIndirect. Everything is uploaded by the constructor, nothing can be added later.
+// The meshes draw from it through the MeshRange of their source (see Mesh(const MeshRange &, ...)), and it has to
+// outlive them. the context has to outlive it
+class MeshBuffer {
+   public:
+    struct Source {
+        const Vertex *vertices;
+        size_t vertexCount;
+        const unsigned int *indices;
+        size_t indexCount;
+    };
+
+    VertexFormat format;
+    GLenum indexType;             // GL_UNSIGNED_SHORT when every source has at most MAX_16BIT_VERTICES vertices
+    std::vector<MeshRange> ranges;  // one per source, in order
+
+    MeshBuffer(const std::vector<Source> &sources, VertexFormat format) : format(format) {
+        size_t vertexTotal = 0, indexTotal = 0;
+        bool shortIndices = true;
+        for (const Source &source : sources) {
+            vertexTotal += source.vertexCount;
+            indexTotal += source.indexCount;
+            // indices are relative to the base vertex of their mesh, so only the mesh itself has to fit
+            if (source.vertexCount > MAX_16BIT_VERTICES)
+                shortIndices = false;
+        }
+        indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        size_t vertexSize = format == VERTEX_FORMAT_PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+        size_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(unsigned int);
+
+        std::vector<unsigned char> vertexData(vertexTotal * vertexSize), indexData(indexTotal * indexSize);
+        size_t firstVertex = 0, firstIndex = 0;
+        for (const Source &source : sources) {
+            PackedBounds bounds = Mesh::packedBounds(source.vertices, source.vertexCount);
+            MeshRange range = {0, indexType, firstIndex, (int)firstVertex, source.vertexCount, source.indexCount, bounds};
+            unsigned char *vertices = vertexData.data() + firstVertex * vertexSize;
+            if (format == VERTEX_FORMAT_PACKED) {
+                Mesh::packVertices(source.vertices, source.vertexCount, range.bounds, (PackedVertex *)vertices);
+            } else if (source.vertexCount > 0) {
+                memcpy(vertices, source.vertices, source.vertexCount * sizeof(Vertex));
+            }
+            if (shortIndices) {
+                uint16_t *indices = (uint16_t *)(indexData.data() + firstIndex * indexSize);
+                for (size_t i = 0; i < source.indexCount; i++)
+                    indices[i] = (uint16_t)source.indices[i];
+            } else if (source.indexCount > 0) {
+                memcpy(indexData.data() + firstIndex * indexSize, source.indices, source.indexCount * indexSize);
+            }
+            ranges.push_back(range);
+            firstVertex += source.vertexCount;
+            firstIndex += source.indexCount;
+        }
+        vertexBytes = vertexData.size();
+        indexBytes = indexData.size();
+
+        GLState &state = GLState::shared();
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        state.bindVertexArray(VAO);
+        // immutable storage can't be empty
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, std::max(indexBytes, (size_t)1), indexBytes > 0 ? indexData.data() : NULL, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferStorage(GL_ARRAY_BUFFER, std::max(vertexBytes, (size_t)1), vertexBytes > 0 ? vertexData.data() : NULL, 0);
+        Mesh::setupAttributes(format);
+        // unbound so later GL_ELEMENT_ARRAY_BUFFER binds can't change this VAO
+        state.bindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        for (MeshRange &range : ranges)
+            range.VAO = VAO;
+    }
+
+    MeshBuffer(const MeshBuffer &) = delete;
+    MeshBuffer &operator=(const MeshBuffer &) = delete;
+
+    ~MeshBuffer() {
+        GLState::shared().forgetVertexArray(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        unsigned int buffers[] = {VBO, EBO, commandBuffer, meshBlock};
+        glDeleteBuffers(4, buffers);
+    }
+
+    // writes the indirect commands, one per range in the given order of range indices. the MeshBlock element of
+    // each command sits at the same position, so a multi-draw over part of the order still finds its bounds
+    void setDrawOrder(const std::vector<unsigned int> &order) {
+        commands.clear();
+        commandInstances = 1;
+        std::vector<MeshBlockData> meshData;
+        for (unsigned int index : order) {
+            const MeshRange &range = ranges[index];
+            commands.push_back({(unsigned int)range.indexCount, 1, (unsigned int)range.firstIndex, range.baseVertex, (unsigned int)commands.size()});
+            meshData.push_back({glm::vec4(range.bounds.scale, 0.0f), glm::vec4(range.bounds.offset, 0.0f)});
+        }
+
+        // immutable, so a new order gets new buffers. only the instance counts of the commands change later
+        unsigned int buffers[] = {commandBuffer, meshBlock};
+        glDeleteBuffers(2, buffers);
+        glGenBuffers(1, &commandBuffer);
+        glGenBuffers(1, &meshBlock);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferStorage(GL_DRAW_INDIRECT_BUFFER, std::max(commands.size(), (size_t)1) * sizeof(DrawElementsIndirectCommand), commands.empty() ? NULL : commands.data(),
+                        GL_DYNAMIC_STORAGE_BIT);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshBlock);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, std::max(meshData.size(), (size_t)1) * sizeof(MeshBlockData), meshData.empty() ? NULL : meshData.data(), 0);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // binds the VAO, the indirect commands and MeshBlock for multiDraw
+    void bind() const {
+        GLState::shared().bindVertexArray(VAO);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_BLOCK_BINDING, meshBlock);
+    }
+
+    // draws count commands of the draw order starting at first, with one call. instanceCount copies of each for
+    // multi-view passes, the commands are rewritten when it differs from the last multi-draw
+    void multiDraw(size_t first, size_t count, unsigned int instanceCount = 1) const {
+        if (instanceCount != commandInstances && !commands.empty()) {
+            commandInstances = instanceCount;
+            for (DrawElementsIndirectCommand &command : commands)
+                command.instanceCount = instanceCount;
+            glNamedBufferSubData(commandBuffer, 0, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data());
+        }
+        glMultiDrawElementsIndirect(GL_TRIANGLES, indexType, (const void *)(first * sizeof(DrawElementsIndirectCommand)), (GLsizei)count, 0);
+        GLState::shared().countDraws();
+    }
+
+    size_t bytes() const {
+        return vertexBytes + indexBytes;
+    }
+
+   private:
+    unsigned int VAO = 0, VBO = 0, EBO = 0, commandBuffer = 0, meshBlock = 0;
+    size_t vertexBytes = 0, indexBytes = 0;
+    // the contents of commandBuffer
+    mutable std::vector<DrawElementsIndirectCommand> commands;
+    mutable unsigned int commandInstances = 1;
+};
+
+#endif
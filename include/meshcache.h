@@ -0,0 +1,221 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <hash.h>
+#include <mappedfile.h>
+#include <mesh.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary cache of imported meshes so warm loads skip the assimp import entirely.
+// Layout (all sections 4 byte aligned):
+//   MeshCacheHeader
+//   per mesh: MeshCacheEntry, vertices, indices, textures (type length, path length, type, path)
+const uint32_t MESH_CACHE_MAGIC = 0x4353484d;  // "MHSC"
+const uint32_t MESH_CACHE_VERSION = 1;
+
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexSize;
+    uint32_t meshCount;
+    uint64_t sourceKey;
+};
+
+struct MeshCacheEntry {
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t textureCount;
+    uint32_t reserved;
+};
+
+class MeshCache {
+   public:
+    // view of one cached mesh, vertex and index pointers point straight into the mapping
+    struct MeshView {
+        const Vertex *vertices;
+        uint32_t vertexCount;
+        const unsigned int *indices;
+        uint32_t indexCount;
+        vector<Texture> textures;  // only type and path are filled in
+    };
+
+    vector<MeshView> meshes;
+
+    // cache files live next to the source file
+    static string pathFor(const string &sourcePath) {
+        return sourcePath + ".meshcache";
+    }
+
+    // key over the source file contents, the material libraries it uses, the import and post processing flags and the
+    // cache format, 0 if the source can't be read. the cached texture paths come from the material libraries, so an
+    // edited .mtl has to miss the cache as well
+    static uint64_t sourceKey(const string &sourcePath, unsigned int importFlags, unsigned int processFlags = 0) {
+        MappedFile source(sourcePath);
+        if (!source.isOpen())
+            return 0;
+        uint64_t key = hashBytes(source.data(), source.size());
+        for (const string &library : materialLibraries(sourcePath, source.data(), source.size())) {
+            // a missing library gets a key of its own, so creating it later misses the cache too
+            MappedFile file(library);
+            key = hashCombine(key, hashString(library));
+            key = hashCombine(key, file.isOpen() ? hashBytes(file.data(), file.size()) : 0);
+        }
+        key = hashCombine(key, importFlags);
+        key = hashCombine(key, processFlags);
+        key = hashCombine(key, MESH_CACHE_VERSION);
+        return hashCombine(key, sizeof(Vertex));
+    }
+
+    // the material libraries a source may load: the mtllib statements of an OBJ, which the native loader and assimp
+    // both look up next to it, and the .mtl with the name of the source, which assimp falls back to
+    static vector<string> materialLibraries(const string &sourcePath, const unsigned char *data, size_t size) {
+        size_t slash = sourcePath.find_last_of('/');
+        string directory = slash == string::npos ? "." : sourcePath.substr(0, slash);
+        size_t dot = sourcePath.find_last_of('.');
+        string stem = dot == string::npos || (slash != string::npos && dot < slash) ? sourcePath : sourcePath.substr(0, dot);
+        vector<string> libraries = {stem + ".mtl"};
+        string extension = stem.size() < sourcePath.size() ? sourcePath.substr(stem.size()) : "";
+        for (char &c : extension)
+            c = (char)tolower((unsigned char)c);
+        if (extension != ".obj")
+            return libraries;
+
+        const char *p = (const char *)data, *end = p + size;
+        while (p < end) {
+            const char *eol = (const char *)memchr(p, '\n', end - p);
+            if (eol == NULL)
+                eol = end;
+            while (p < eol && (*p == ' ' || *p == '\t'))
+                p++;
+            if (eol - p > 6 && memcmp(p, "mtllib", 6) == 0 && (p[6] == ' ' || p[6] == '\t')) {
+                // the rest of the line, trimmed the same way ObjLoader does
+                const char *name = p + 6, *nameEnd = eol;
+                while (name < nameEnd && (*name == ' ' || *name == '\t'))
+                    name++;
+                while (nameEnd > name && (nameEnd[-1] == ' ' || nameEnd[-1] == '\t' || nameEnd[-1] == '\r'))
+                    nameEnd--;
+                string library = directory + '/' + string(name, nameEnd);
+                if (find(libraries.begin(), libraries.end(), library) == libraries.end())
+                    libraries.push_back(library);
+            }
+            p = eol + 1;
+        }
+        return libraries;
+    }
+
+    // maps the cache file and validates it against the expected key
+    bool open(const string &cachePath, uint64_t key) {
+        meshes.clear();
+        if (key == 0 || !file.open(cachePath))
+            return false;
+
+        const unsigned char *cursor = file.data();
+        const unsigned char *end = cursor + file.size();
+        MeshCacheHeader header;
+        if (!read(cursor, end, &header, sizeof(header)) || header.magic != MESH_CACHE_MAGIC ||
+            header.version != MESH_CACHE_VERSION || header.vertexSize != sizeof(Vertex) || header.sourceKey != key) {
+            file.close();
+            return false;
+        }
+
+        meshes.reserve(header.meshCount);
+        for (uint32_t i = 0; i < header.meshCount; i++) {
+            MeshCacheEntry entry;
+            if (!read(cursor, end, &entry, sizeof(entry)) ||
+                (size_t)(end - cursor) < (size_t)entry.vertexCount * sizeof(Vertex) + (size_t)entry.indexCount * sizeof(unsigned int)) {
+                meshes.clear();
+                file.close();
+                return false;
+            }
+            MeshView view;
+            view.vertices = (const Vertex *)cursor;
+            view.vertexCount = entry.vertexCount;
+            cursor += (size_t)entry.vertexCount * sizeof(Vertex);
+            view.indices = (const unsigned int *)cursor;
+            view.indexCount = entry.indexCount;
+            cursor += (size_t)entry.indexCount * sizeof(unsigned int);
+
+            for (uint32_t t = 0; t < entry.textureCount; t++) {
+                uint32_t lengths[2];
+                if (!read(cursor, end, lengths, sizeof(lengths)) || (size_t)(end - cursor) < align4((size_t)lengths[0] + lengths[1])) {
+                    meshes.clear();
+                    file.close();
+                    return false;
+                }
+                Texture texture;
+                texture.id = 0;
+                texture.type.assign((const char *)cursor, lengths[0]);
+                texture.path.assign((const char *)cursor + lengths[0], lengths[1]);
+                cursor += align4((size_t)lengths[0] + lengths[1]);
+                view.textures.push_back(texture);
+            }
+            meshes.push_back(view);
+        }
+        return true;
+    }
+
+    // releases the mapping once the meshes have been uploaded
+    void close() {
+        meshes.clear();
+        file.close();
+    }
+
+    // writes the meshes to a temporary file and moves it into place so readers never see a partial cache
+    static bool write(const string &cachePath, uint64_t key, const vector<MeshData> &meshes) {
+        if (key == 0)
+            return false;
+        string tempPath = cachePath + ".tmp";
+        ofstream out(tempPath, ios::binary | ios::trunc);
+        if (!out)
+            return false;
+
+        MeshCacheHeader header = {MESH_CACHE_MAGIC, MESH_CACHE_VERSION, (uint32_t)sizeof(Vertex), (uint32_t)meshes.size(), key};
+        out.write((const char *)&header, sizeof(header));
+        for (const MeshData &mesh : meshes) {
+            MeshCacheEntry entry = {(uint32_t)mesh.vertices.size(), (uint32_t)mesh.indices.size(), (uint32_t)mesh.textures.size(), 0};
+            out.write((const char *)&entry, sizeof(entry));
+            out.write((const char *)mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            out.write((const char *)mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+            for (const Texture &texture : mesh.textures) {
+                uint32_t lengths[2] = {(uint32_t)texture.type.size(), (uint32_t)texture.path.size()};
+                out.write((const char *)lengths, sizeof(lengths));
+                out.write(texture.type.data(), texture.type.size());
+                out.write(texture.path.data(), texture.path.size());
+                static const char padding[4] = {0, 0, 0, 0};
+                out.write(padding, align4(lengths[0] + lengths[1]) - (lengths[0] + lengths[1]));
+            }
+        }
+        out.close();
+        if (!out) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        std::remove(cachePath.c_str());
+        return std::rename(tempPath.c_str(), cachePath.c_str()) == 0;
+    }
+
+   private:
+    MappedFile file;
+
+    static size_t align4(size_t size) {
+        return (size + 3) & ~(size_t)3;
+    }
+
+    static bool read(const unsigned char *&cursor, const unsigned char *end, void *dest, size_t size) {
+        if ((size_t)(end - cursor) < size)
+            return false;
+        std::memcpy(dest, cursor, size);
+        cursor += size;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,308 @@
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+#include <hash.h>
+#include <mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <vector>
+
+// Vertex welding, splitting for 16 bit indices, and post-transform cache and overdraw optimization for triangle lists:
+//   0. duplicate vertices are merged with a hash table, exactly or within an epsilon
+//   1. Tipsify (Sander, Nehab, Barczak 2007) reorders triangles for a FIFO vertex cache
+//   2. the clusters Tipsify produces are sorted so outward facing ones are drawn first, which cuts overdraw
+//   3. vertices are reordered to the order the index buffer first touches them, for linear vertex fetch
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+struct MeshOptStats {
+    unsigned int vertices = 0;
+    unsigned int triangles = 0;
+    float acmrBefore = 0.0f;  // average cache miss ratio: vertex shader runs per triangle (0.5 is ideal, 3 is worst)
+    float acmrAfter = 0.0f;
+    float atvrBefore = 0.0f;  // average transform to vertex ratio: vertex shader runs per vertex (1 is ideal)
+    float atvrAfter = 0.0f;
+};
+
+// merges vertices that are bit identical (epsilon 0) or whose attributes all round to the same multiple of epsilon,
+// the first vertex of every group is kept. returns the number of vertices removed.
+// rounding puts every attribute in a grid cell of size epsilon and merges vertices in the same cell, it isn't a
+// distance test: values closer than epsilon on either side of a cell boundary stay apart.
+inline size_t weldVertices(vector<Vertex> &vertices, vector<unsigned int> &indices, float epsilon = 0.0f) {
+    const size_t FLOATS = sizeof(Vertex) / sizeof(float);
+    static_assert(sizeof(Vertex) == FLOATS * sizeof(float), "welding compares vertices as plain float arrays");
+
+    // the key of a vertex is its raw bits, or its attributes snapped to the epsilon grid. grid cells past +-2^62
+    // (and NaNs) keep their bits instead, offset below every cell so the two kinds of key can't meet
+    const double CELL_LIMIT = 4611686018427387904.0;  // 2^62
+    auto makeKey = [&](const Vertex &vertex, int64_t *key) {
+        const float *values = (const float *)&vertex;
+        for (size_t i = 0; i < FLOATS; i++) {
+            uint32_t bits;
+            std::memcpy(&bits, &values[i], sizeof(bits));
+            double snapped = epsilon > 0.0f ? std::floor((double)values[i] / epsilon + 0.5) : 0.0;
+            if (epsilon > 0.0f && std::fabs(snapped) < CELL_LIMIT)
+                key[i] = (int64_t)snapped;
+            else
+                key[i] = INT64_MIN + (int64_t)bits;
+        }
+    };
+
+    size_t capacity = 1;
+    while (capacity < vertices.size() * 2)
+        capacity <<= 1;
+    const unsigned int empty = ~0u;
+    vector<unsigned int> table(capacity, empty);  // open addressing, holds indices into welded
+    vector<int64_t> keys;                         // FLOATS per welded vertex
+    keys.reserve(vertices.size() * FLOATS);
+    vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    vector<unsigned int> remap(vertices.size());
+
+    int64_t key[sizeof(Vertex) / sizeof(float)];
+    for (size_t v = 0; v < vertices.size(); v++) {
+        makeKey(vertices[v], key);
+        size_t slot = hashBytes(key, sizeof(key)) & (capacity - 1);
+        while (table[slot] != empty && std::memcmp(&keys[table[slot] * FLOATS], key, sizeof(key)) != 0)
+            slot = (slot + 1) & (capacity - 1);
+        if (table[slot] == empty) {
+            table[slot] = (unsigned int)welded.size();
+            welded.push_back(vertices[v]);
+            keys.insert(keys.end(), key, key + FLOATS);
+        }
+        remap[v] = table[slot];
+    }
+
+    for (unsigned int &index : indices)
+        index = remap[index];
+    size_t removed = vertices.size() - welded.size();
+    vertices.swap(welded);
+    return removed;
+}
+
+// splits a mesh into parts of at most maxVertices vertices so each can use 16 bit indices. triangles stay in
+// their order, so an optimized mesh stays optimized, and every part's vertices are in first use order.
+inline vector<MeshData> splitMesh(const MeshData &mesh, size_t maxVertices = MAX_16BIT_VERTICES) {
+    vector<MeshData> parts;
+    const unsigned int unused = ~0u;
+    vector<unsigned int> remap(mesh.vertices.size(), unused);
+    vector<unsigned int> touched;  // vertices of the current part, to reset remap when it's full
+    MeshData part;
+    for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+        size_t added = 0;
+        for (int k = 0; k < 3; k++)
+            if (remap[mesh.indices[t + k]] == unused)
+                added++;
+        if (part.vertices.size() + added > maxVertices) {
+            part.textures = mesh.textures;
+            parts.push_back(std::move(part));
+            part = MeshData();
+            for (unsigned int v : touched)
+                remap[v] = unused;
+            touched.clear();
+        }
+        for (int k = 0; k < 3; k++) {
+            unsigned int index = mesh.indices[t + k];
+            if (remap[index] == unused) {
+                remap[index] = (unsigned int)part.vertices.size();
+                part.vertices.push_back(mesh.vertices[index]);
+                touched.push_back(index);
+            }
+            part.indices.push_back(remap[index]);
+        }
+    }
+    if (!part.indices.empty() || parts.empty()) {
+        part.textures = mesh.textures;
+        parts.push_back(std::move(part));
+    }
+    return parts;
+}
+
+// simulates a FIFO post-transform cache and returns the number of vertex shader invocations
+inline unsigned int simulateVertexCache(const vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE) {
+    vector<unsigned int> insertedAt(vertexCount, 0);
+    unsigned int misses = 0;
+    for (unsigned int index : indices) {
+        // a vertex is cached if fewer than cacheSize other vertices went in since it was inserted
+        if (insertedAt[index] == 0 || misses + 1 - insertedAt[index] > cacheSize) {
+            misses++;
+            insertedAt[index] = misses;
+        }
+    }
+    return misses;
+}
+
+// Tipsify triangle reordering, also returns the first triangle of every cluster (a cluster ends where the
+// algorithm had to jump to an unrelated part of the mesh)
+inline vector<unsigned int> tipsify(const vector<unsigned int> &indices, size_t vertexCount, unsigned int cacheSize, vector<unsigned int> &clusters) {
+    size_t triangleCount = indices.size() / 3;
+
+    // vertex -> triangle adjacency in compressed rows
+    vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int index : indices)
+        offsets[index + 1]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] += offsets[v];
+    vector<unsigned int> adjacency(indices.size());
+    vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++)
+        for (int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+
+    vector<unsigned int> liveTriangles(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        liveTriangles[v] = offsets[v + 1] - offsets[v];
+    vector<unsigned int> cacheTime(vertexCount, 0);
+    vector<bool> emitted(triangleCount, false);
+    vector<unsigned int> deadEnd;
+    vector<unsigned int> candidates;
+    vector<unsigned int> output;
+    output.reserve(indices.size());
+    clusters.clear();
+
+    unsigned int time = cacheSize + 1;
+    size_t cursor = 0;
+    long long fanning = 0;
+    bool newCluster = true;
+    while (fanning >= 0) {
+        candidates.clear();
+        for (unsigned int a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+            unsigned int t = adjacency[a];
+            if (emitted[t])
+                continue;
+            if (newCluster) {
+                clusters.push_back((unsigned int)(output.size() / 3));
+                newCluster = false;
+            }
+            for (int k = 0; k < 3; k++) {
+                unsigned int v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // the next fanning vertex is the candidate that will still be in the cache when its fan gets emitted
+        long long next = -1;
+        int bestPriority = -1;
+        for (unsigned int v : candidates) {
+            if (liveTriangles[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = (int)(time - cacheTime[v]);
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        if (next == -1) {
+            // dead end: back track through recently used vertices, then scan for any vertex with triangles left
+            newCluster = true;
+            while (!deadEnd.empty() && next == -1) {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0)
+                    next = v;
+            }
+            while (next == -1 && cursor < vertexCount) {
+                if (liveTriangles[cursor] > 0)
+                    next = (long long)cursor;
+                cursor++;
+            }
+        }
+        fanning = next;
+    }
+    return output;
+}
+
+// sorts the clusters so that those facing away from the mesh center (and likely occluding the rest) come first
+inline vector<unsigned int> sortClustersForOverdraw(const vector<Vertex> &vertices, const vector<unsigned int> &indices, const vector<unsigned int> &clusters) {
+    size_t triangleCount = indices.size() / 3;
+    glm::vec3 meshCenter(0.0f);
+    for (const Vertex &vertex : vertices)
+        meshCenter += vertex.Position;
+    if (!vertices.empty())
+        meshCenter /= (float)vertices.size();
+
+    struct Cluster {
+        unsigned int begin, end;
+        float sortKey;
+    };
+    vector<Cluster> sorted;
+    for (size_t c = 0; c < clusters.size(); c++) {
+        Cluster cluster;
+        cluster.begin = clusters[c];
+        cluster.end = c + 1 < clusters.size() ? clusters[c + 1] : (unsigned int)triangleCount;
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (unsigned int t = cluster.begin; t < cluster.end; t++) {
+            glm::vec3 a = vertices[indices[t * 3]].Position, b = vertices[indices[t * 3 + 1]].Position, c2 = vertices[indices[t * 3 + 2]].Position;
+            glm::vec3 cross = glm::cross(b - a, c2 - a);  // length is twice the area
+            float triangleArea = glm::length(cross);
+            centroid += (a + b + c2) / 3.0f * triangleArea;
+            normal += cross;
+            area += triangleArea;
+        }
+        float normalLength = glm::length(normal);
+        cluster.sortKey = 0.0f;
+        if (area > 0.0f && normalLength > 0.0f)
+            cluster.sortKey = glm::dot(centroid / area - meshCenter, normal / normalLength);
+        sorted.push_back(cluster);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster &a, const Cluster &b) { return a.sortKey > b.sortKey; });
+
+    vector<unsigned int> output;
+    output.reserve(indices.size());
+    for (const Cluster &cluster : sorted)
+        output.insert(output.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    return output;
+}
+
+// renumbers the vertices in the order the index buffer first references them, unreferenced vertices are dropped
+inline void reorderVertexFetch(vector<Vertex> &vertices, vector<unsigned int> &indices) {
+    const unsigned int unused = ~0u;
+    vector<unsigned int> remap(vertices.size(), unused);
+    vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+    for (unsigned int &index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = (unsigned int)reordered.size();
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices.swap(reordered);
+}
+
+// runs all three passes on a mesh and reports the cache efficiency before and after
+inline MeshOptStats optimizeMesh(MeshData &mesh, unsigned int cacheSize = VERTEX_CACHE_SIZE) {
+    MeshOptStats stats;
+    stats.vertices = (unsigned int)mesh.vertices.size();
+    stats.triangles = (unsigned int)(mesh.indices.size() / 3);
+    if (stats.triangles == 0 || mesh.indices.size() % 3 != 0)
+        return stats;
+
+    unsigned int missesBefore = simulateVertexCache(mesh.indices, mesh.vertices.size(), cacheSize);
+    stats.acmrBefore = (float)missesBefore / stats.triangles;
+    stats.atvrBefore = (float)missesBefore / stats.vertices;
+
+    vector<unsigned int> clusters;
+    vector<unsigned int> reordered = tipsify(mesh.indices, mesh.vertices.size(), cacheSize, clusters);
+    mesh.indices = sortClustersForOverdraw(mesh.vertices, reordered, clusters);
+    reorderVertexFetch(mesh.vertices, mesh.indices);
+
+    unsigned int missesAfter = simulateVertexCache(mesh.indices, mesh.vertices.size(), cacheSize);
+    stats.acmrAfter = (float)missesAfter / stats.triangles;
+    stats.atvrAfter = (float)missesAfter / std::max(1u, (unsigned int)mesh.vertices.size());
+    return stats;
+}
+
+#endif
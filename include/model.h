@@ -4,85 +4,465 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <glad/glad.h>
+#include <glstate.h>
+#include <instancebuffer.h>
+#include <ktx2.h>
 #include <mesh.h>
+#include <meshbuffer.h>
+#include <meshcache.h>
+#include <meshopt.h>
+#include <objloader.h>
+#include <renderqueue.h>
 #include <shader.h>
+#include <shaderuniforms.h>
+#include <shadervariants.h>
 #include <stb_image.h>
+#include <texturecache.h>
+#include <threadpool.h>
 
 #include <assimp/Importer.hpp>
+#include <cctype>
 #include <fstream>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 using namespace std;
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
 
+// options for how a model gets loaded
+enum ModelFlags {
+    MODEL_USE_CACHE = 1 << 0,         // read/write the binary mesh cache next to the source file
+    MODEL_OPTIMIZE = 1 << 1,          // reorder triangles and vertices for the vertex cache, overdraw and vertex fetch
+    MODEL_PACKED_VERTICES = 1 << 2,   // upload 24 byte PackedVertex instead of Vertex, draw with shaders/multilight_packed.vs
+    MODEL_WELD = 1 << 3,              // merge bit identical vertices
+    MODEL_WELD_NEAR = 1 << 4,         // also merge vertices whose attributes all fall in the same MODEL_WELD_EPSILON grid cell
+    MODEL_SPLIT_16BIT = 1 << 5,       // split meshes with more than 65536 vertices so every part gets 16 bit indices
+    MODEL_GPU_ONLY = 1 << 6,          // free the CPU copies of vertices and indices once they are uploaded
+    MODEL_NATIVE_OBJ = 1 << 7,        // load .obj files with ObjLoader instead of ASSIMP
+    MODEL_MULTI_DRAW = 1 << 8         // upload all meshes into one MeshBuffer and draw each material with one multi-draw
+};
+
+// the flags that change the converted mesh data and therefore the mesh cache contents
+const unsigned int MODEL_PROCESS_FLAGS = MODEL_OPTIMIZE | MODEL_WELD | MODEL_WELD_NEAR | MODEL_SPLIT_16BIT | MODEL_NATIVE_OBJ;
+
+// what a Model is loaded with unless the flags are given
+const unsigned int MODEL_DEFAULT_FLAGS = MODEL_USE_CACHE | MODEL_OPTIMIZE | MODEL_WELD | MODEL_NATIVE_OBJ | MODEL_MULTI_DRAW;
+
+const float MODEL_WELD_EPSILON = 1e-5f;
+
+const unsigned int MODEL_IMPORT_FLAGS = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+
 class Model {
    public:
     // model data
-    vector<Texture> textures_loaded;  // stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
+    vector<Texture> textures_loaded;  // stores all the textures this model references, each holds one reference in the shared TextureCache.
     vector<Mesh> meshes;
     string directory;
     bool gammaCorrection;
+    unsigned int flags;
+    bool loadedFromCache = false;
+    vector<MeshOptStats> optimizeStats;  // cache efficiency before/after optimization per imported (unsplit) mesh, empty when loaded from the cache
 
     // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma) {
+    Model(string const &path, bool gamma = false, unsigned int flags = MODEL_DEFAULT_FLAGS) : gammaCorrection(gamma), flags(flags) {
         loadModel(path);
     }
 
+    // a Model owns its meshes and texture references, so it can be moved but not copied
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+    Model(Model &&other) noexcept = default;
+
+    Model &operator=(Model &&other) noexcept {
+        if (this != &other) {
+            releaseTextures();
+            textures_loaded = std::move(other.textures_loaded);
+            meshes = std::move(other.meshes);
+            directory = std::move(other.directory);
+            gammaCorrection = other.gammaCorrection;
+            flags = other.flags;
+            loadedFromCache = other.loadedFromCache;
+            optimizeStats = std::move(other.optimizeStats);
+            loadedIndices = std::move(other.loadedIndices);
+            meshBuffer = std::move(other.meshBuffer);
+            drawGroups = std::move(other.drawGroups);
+            other.textures_loaded.clear();
+        }
+        return *this;
+    }
+
+    ~Model() {
+        releaseTextures();
+    }
+
     // draws the model, and thus all its meshes
     void Draw(Shader &shader) {
         for (unsigned int i = 0; i < meshes.size(); i++)
             meshes[i].Draw(shader);
     }
 
+    // draws every mesh with the cheapest variant that covers it: the given variant, plus normal mapping
+    // for meshes that have a normal map. the model matrix is set on each program the first time it's used.
+    // meshes whose variant is still being built asynchronously are skipped.
+    // with MODEL_MULTI_DRAW the meshes of each material go out in one glMultiDrawElementsIndirect
+    void Draw(ShaderVariants &variants, unsigned int variant, const glm::mat4 &model) {
+        Shader *current = NULL;
+        if (meshBuffer) {
+            meshBuffer->bind();
+            // packed meshes read their bounds from MeshBlock, one uniform can't hold them all
+            if (vertexFormat() == VERTEX_FORMAT_PACKED)
+                variant |= SHADER_MULTI_DRAW;
+            for (const DrawGroup &group : drawGroups) {
+                Shader *shader = variants.get(group.normalMap ? variant | SHADER_NORMAL_MAP : variant & ~SHADER_NORMAL_MAP);
+                if (shader == NULL)
+                    continue;
+                if (shader != current) {
+                    current = shader;
+                    shader->use();
+                    shader->setmatrix4(shaderuniforms::multilight_vs::MODEL, model);
+                }
+                // every mesh of the group has the same textures
+                meshes[group.mesh].Bind(*shader);
+                meshBuffer->multiDraw(group.firstCommand, group.commandCount);
+            }
+            return;
+        }
+        for (unsigned int i = 0; i < meshes.size(); i++) {
+            Shader *shader = variants.get(meshes[i].hasTexture("texture_normal") ? variant | SHADER_NORMAL_MAP : variant & ~SHADER_NORMAL_MAP);
+            if (shader == NULL)
+                continue;
+            if (shader != current) {
+                current = shader;
+                shader->use();
+                shader->setmatrix4(shaderuniforms::multilight_vs::MODEL, model);
+            }
+            meshes[i].Draw(*shader);
+        }
+    }
+
+    // draws every instance of the model with one draw call per mesh. shader has to be built with INSTANCED
+    void DrawInstanced(Shader &shader, const InstanceBuffer &instances) {
+        if (instances.size() == 0)
+            return;
+        instances.bind();
+        for (unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].DrawInstanced(shader, instances.size());
+    }
+
+    // the instanced counterpart of Draw(variants, variant, model): the variants get SHADER_INSTANCED and read their
+    // transforms from instances instead of the model uniform
+    void DrawInstanced(ShaderVariants &variants, unsigned int variant, const InstanceBuffer &instances) {
+        if (instances.size() == 0)
+            return;
+        instances.bind();
+        variant |= SHADER_INSTANCED;
+        Shader *current = NULL;
+        for (unsigned int i = 0; i < meshes.size(); i++) {
+            Shader *shader = variants.get(meshes[i].hasTexture("texture_normal") ? variant | SHADER_NORMAL_MAP : variant & ~SHADER_NORMAL_MAP);
+            if (shader == NULL)
+                continue;
+            if (shader != current) {
+                current = shader;
+                shader->use();
+            }
+            meshes[i].DrawInstanced(*shader, instances.size());
+        }
+    }
+
+    // queues the draws of Draw(variants, variant, model) instead of issuing them. transparent models go in mesh by
+    // mesh so each one gets its own depth, opaque ones as their multi-draws when they have them
+    void Submit(RenderQueue &queue, ShaderVariants &variants, unsigned int variant, const glm::mat4 &model, RenderPass pass = RENDER_PASS_OPAQUE) {
+        unsigned int transform = queue.addTransform(model);
+        if (meshBuffer && pass == RENDER_PASS_OPAQUE) {
+            unsigned int multiVariant = vertexFormat() == VERTEX_FORMAT_PACKED ? variant | SHADER_MULTI_DRAW : variant;
+            for (const DrawGroup &group : drawGroups) {
+                RenderCommand command;
+                command.shader = variants.get(group.normalMap ? multiVariant | SHADER_NORMAL_MAP : multiVariant & ~SHADER_NORMAL_MAP);
+                if (command.shader == NULL)
+                    continue;
+                command.mesh = &meshes[group.mesh];
+                command.buffer = meshBuffer.get();
+                command.first = group.firstCommand;
+                command.count = group.commandCount;
+                command.transform = transform;
+                command.center = glm::vec3(model * glm::vec4(group.center, 1.0f));
+                queue.submit(command);
+            }
+            return;
+        }
+        for (Mesh &mesh : meshes) {
+            RenderCommand command;
+            command.shader = variants.get(mesh.hasTexture("texture_normal") ? variant | SHADER_NORMAL_MAP : variant & ~SHADER_NORMAL_MAP);
+            if (command.shader == NULL)
+                continue;
+            command.mesh = &mesh;
+            command.transform = transform;
+            command.center = glm::vec3(model * glm::vec4(mesh.bounds.offset, 1.0f));
+            command.pass = pass;
+            queue.submit(command);
+        }
+    }
+
+    // queues the draws of DrawInstanced(variants, variant, instances), at the depth of the average instance.
+    // instances of one draw can't be sorted against each other, so transparent ones are queued one by one through
+    // Submit instead, each at its own depth
+    void SubmitInstanced(RenderQueue &queue, ShaderVariants &variants, unsigned int variant, const InstanceBuffer &instances, RenderPass pass = RENDER_PASS_OPAQUE) {
+        if (instances.size() == 0)
+            return;
+        if (pass == RENDER_PASS_TRANSPARENT) {
+            for (size_t i = 0; i < instances.size(); i++)
+                Submit(queue, variants, variant & ~SHADER_INSTANCED, instances.model(i), pass);
+            return;
+        }
+        variant |= SHADER_INSTANCED;
+        for (Mesh &mesh : meshes) {
+            RenderCommand command;
+            command.shader = variants.get(mesh.hasTexture("texture_normal") ? variant | SHADER_NORMAL_MAP : variant & ~SHADER_NORMAL_MAP);
+            if (command.shader == NULL)
+                continue;
+            command.mesh = &mesh;
+            command.instances = &instances;
+            command.center = glm::vec3(instances.averageModel() * glm::vec4(mesh.bounds.offset, 1.0f));
+            command.pass = pass;
+            queue.submit(command);
+        }
+    }
+
    private:
+    // meshes with the same textures, drawn by commands [firstCommand, firstCommand + commandCount) of meshBuffer
+    struct DrawGroup {
+        bool normalMap;
+        unsigned int mesh;  // any mesh of the group, for its texture bindings
+        size_t firstCommand, commandCount;
+        glm::vec3 center;  // average of the mesh centers, in model space
+    };
+
+    std::unique_ptr<MeshBuffer> meshBuffer;  // with MODEL_MULTI_DRAW, holds the vertices and indices of every mesh
+    vector<DrawGroup> drawGroups;
+
+    VertexFormat vertexFormat() const {
+        return flags & MODEL_PACKED_VERTICES ? VERTEX_FORMAT_PACKED : VERTEX_FORMAT_FLOAT;
+    }
+
+    bool keepCpuData() const {
+        return !(flags & MODEL_GPU_ONLY);
+    }
+
+    void releaseTextures() {
+        for (const Texture &texture : textures_loaded)
+            TextureCache::shared().release(texture.id);
+        textures_loaded.clear();
+        loadedIndices.clear();
+    }
+
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const &path) {
-        // read file via ASSIMP
-        Assimp::Importer importer;
-        const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-        // check for errors
-        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)  // if is Not Zero
-        {
-            cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-            return;
-        }
         // retrieve the directory path of the filepath
         directory = path.substr(0, path.find_last_of('/'));
 
-        // process ASSIMP's root node recursively
-        processNode(scene->mRootNode, scene);
+        // a valid cache for the current source file, import flags and processing steps skips assimp altogether
+        uint64_t cacheKey = 0;
+        if (flags & MODEL_USE_CACHE) {
+            cacheKey = MeshCache::sourceKey(path, MODEL_IMPORT_FLAGS, flags & MODEL_PROCESS_FLAGS);
+            if (loadFromCache(MeshCache::pathFor(path), cacheKey))
+                return;
+        }
+
+        // OBJ files go through the native loader, everything else (and OBJs it fails on) through ASSIMP
+        vector<MeshData> imported;
+        bool native = (flags & MODEL_NATIVE_OBJ) && isObjFile(path) && ObjLoader::load(path, imported);
+        if (!native) {
+            // read file via ASSIMP
+            Assimp::Importer importer;
+            const aiScene *scene = importer.ReadFile(path, MODEL_IMPORT_FLAGS);
+            // check for errors
+            if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)  // if is Not Zero
+            {
+                cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+                return;
+            }
+
+            // process ASSIMP's root node recursively
+            processNode(scene->mRootNode, scene, imported);
+        }
+        vector<MeshData> converted;
+        postProcess(imported, converted);
+
+        // the cache is written from the converted data, the meshes may not keep a CPU copy
+        if (flags & MODEL_USE_CACHE) {
+            if (!MeshCache::write(MeshCache::pathFor(path), cacheKey, converted))
+                cout << "WARNING::MODEL::CACHE:: could not write mesh cache for " << path << endl;
+        }
+
+        // texture loading and buffer uploads need the GL context, so they happen here in order
+        meshes.reserve(converted.size());
+        if (flags & MODEL_MULTI_DRAW) {
+            vector<MeshBuffer::Source> sources;
+            for (const MeshData &data : converted)
+                sources.push_back({data.vertices.data(), data.vertices.size(), data.indices.data(), data.indices.size()});
+            meshBuffer = std::make_unique<MeshBuffer>(sources, vertexFormat());
+        }
+        for (size_t i = 0; i < converted.size(); i++) {
+            MeshData &data = converted[i];
+            for (Texture &texture : data.textures)
+                texture = loadTexture(texture.path.c_str(), texture.type);
+            if (!meshBuffer) {
+                meshes.emplace_back(std::move(data.vertices), std::move(data.indices), std::move(data.textures), vertexFormat(), keepCpuData());
+            } else if (keepCpuData()) {
+                meshes.emplace_back(meshBuffer->ranges[i], std::move(data.textures), vertexFormat(), std::move(data.vertices), std::move(data.indices));
+            } else {
+                meshes.emplace_back(meshBuffer->ranges[i], std::move(data.textures), vertexFormat());
+            }
+        }
+        setupDrawGroups();
+    }
+
+    // uploads the meshes straight out of the mapped cache file, returns false if the cache is missing or stale
+    bool loadFromCache(string const &cachePath, uint64_t cacheKey) {
+        MeshCache cache;
+        if (!cache.open(cachePath, cacheKey))
+            return false;
+
+        meshes.reserve(cache.meshes.size());
+        if (flags & MODEL_MULTI_DRAW) {
+            vector<MeshBuffer::Source> sources;
+            for (const MeshCache::MeshView &view : cache.meshes)
+                sources.push_back({view.vertices, view.vertexCount, view.indices, view.indexCount});
+            meshBuffer = std::make_unique<MeshBuffer>(sources, vertexFormat());
+        }
+        for (size_t i = 0; i < cache.meshes.size(); i++) {
+            const MeshCache::MeshView &view = cache.meshes[i];
+            vector<Texture> textures;
+            for (const Texture &cached : view.textures)
+                textures.push_back(loadTexture(cached.path.c_str(), cached.type));
+            if (!meshBuffer) {
+                meshes.emplace_back(view.vertices, view.vertexCount, view.indices, view.indexCount, std::move(textures), vertexFormat(), keepCpuData());
+            } else if (keepCpuData()) {
+                meshes.emplace_back(meshBuffer->ranges[i], std::move(textures), vertexFormat(), vector<Vertex>(view.vertices, view.vertices + view.vertexCount),
+                                    vector<unsigned int>(view.indices, view.indices + view.indexCount));
+            } else {
+                meshes.emplace_back(meshBuffer->ranges[i], std::move(textures), vertexFormat());
+            }
+        }
+        setupDrawGroups();
+        loadedFromCache = true;
+        return true;
     }
 
-    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode *node, const aiScene *scene) {
-        // process each mesh located at the current node
-        for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-            // the node object only contains indices to index the actual objects in the scene.
-            // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-            aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-            meshes.push_back(processMesh(mesh, scene));
+    // groups the meshes by their textures in order of first appearance and writes the draw order of meshBuffer to match,
+    // so each group is one contiguous run of indirect commands
+    void setupDrawGroups() {
+        if (!meshBuffer)
+            return;
+        vector<vector<unsigned int>> groupMeshes;
+        for (unsigned int i = 0; i < meshes.size(); i++) {
+            size_t group = 0;
+            while (group < groupMeshes.size() && !sameTextures(meshes[groupMeshes[group][0]], meshes[i]))
+                group++;
+            if (group == groupMeshes.size())
+                groupMeshes.emplace_back();
+            groupMeshes[group].push_back(i);
+        }
+
+        vector<unsigned int> order;
+        for (const vector<unsigned int> &group : groupMeshes) {
+            glm::vec3 center(0.0f);
+            for (unsigned int mesh : group)
+                center += meshes[mesh].bounds.offset / (float)group.size();
+            drawGroups.push_back({meshes[group[0]].hasTexture("texture_normal"), group[0], order.size(), group.size(), center});
+            order.insert(order.end(), group.begin(), group.end());
         }
-        // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-        for (unsigned int i = 0; i < node->mNumChildren; i++) {
-            processNode(node->mChildren[i], scene);
+        meshBuffer->setDrawOrder(order);
+    }
+
+    static bool sameTextures(const Mesh &a, const Mesh &b) {
+        if (a.textures.size() != b.textures.size())
+            return false;
+        for (size_t i = 0; i < a.textures.size(); i++) {
+            if (a.textures[i].id != b.textures[i].id || a.textures[i].type != b.textures[i].type)
+                return false;
         }
+        return true;
+    }
+
+    // processes a node in a recursive fashion. Collects each individual mesh located at the node and repeats this process on its children nodes (if any).
+    void processNode(aiNode *node, const aiScene *scene, vector<MeshData> &imported) {
+        // gather the meshes in the same depth first order the serial walk used, so mesh order never depends on thread timing
+        vector<aiMesh *> sceneMeshes;
+        collectMeshes(node, scene, sceneMeshes);
+
+        // the CPU side conversion of every mesh is independent, so run it on the worker pool
+        size_t first = imported.size();
+        imported.resize(first + sceneMeshes.size());
+        parallelFor(sceneMeshes.size(), [&](size_t i) {
+            imported[first + i] = processMesh(sceneMeshes[i], scene);
+        });
+    }
+
+    // welds, optimizes and splits the imported meshes on the worker pool, a mesh may come out in several parts
+    // when it gets split for 16 bit indices
+    void postProcess(vector<MeshData> &imported, vector<MeshData> &converted) {
+        vector<vector<MeshData>> parts(imported.size());
+        vector<MeshOptStats> stats(imported.size());
+        bool optimize = flags & MODEL_OPTIMIZE;
+        parallelFor(imported.size(), [&](size_t i) {
+            MeshData &data = imported[i];
+            if (flags & (MODEL_WELD | MODEL_WELD_NEAR))
+                weldVertices(data.vertices, data.indices, flags & MODEL_WELD_NEAR ? MODEL_WELD_EPSILON : 0.0f);
+            if (optimize)
+                stats[i] = optimizeMesh(data);
+            if ((flags & MODEL_SPLIT_16BIT) && data.vertices.size() > MAX_16BIT_VERTICES)
+                parts[i] = splitMesh(data);
+            else
+                parts[i].push_back(std::move(data));
+        });
+        if (optimize)
+            optimizeStats.insert(optimizeStats.end(), stats.begin(), stats.end());
+
+        for (vector<MeshData> &meshParts : parts)
+            for (MeshData &data : meshParts)
+                converted.push_back(std::move(data));
+    }
+
+    static bool isObjFile(const string &path) {
+        size_t dot = path.find_last_of('.');
+        if (dot == string::npos)
+            return false;
+        string extension = path.substr(dot + 1);
+        for (char &c : extension)
+            c = (char)std::tolower((unsigned char)c);
+        return extension == "obj";
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene) {
+    void collectMeshes(aiNode *node, const aiScene *scene, vector<aiMesh *> &sceneMeshes) {
+        // the node object only contains indices to index the actual objects in the scene.
+        // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
+            sceneMeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
+        // after we've collected all of the meshes (if any) we then recursively collect each of the children nodes
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+            collectMeshes(node->mChildren[i], scene, sceneMeshes);
+    }
+
+    // converts an assimp mesh into our own vertex/index arrays, runs on worker threads so it must not make GL calls
+    MeshData processMesh(aiMesh *mesh, const aiScene *scene) {
         // data to fill
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
-        vector<Texture> textures;
+        MeshData data;
+        vector<Vertex> &vertices = data.vertices;
+        vector<unsigned int> &indices = data.indices;
+        vertices.reserve(mesh->mNumVertices);
+        indices.reserve(mesh->mNumFaces * 3);
 
         // walk through each of the mesh's vertices
         for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
-            Vertex vertex;
+            Vertex vertex = {};  // zeroed so meshes without tangents convert (and cache) the same on every run
             glm::vec3 vector;  // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
             // positions
             vector.x = mesh->mVertices[i].x;
@@ -137,49 +517,51 @@ class Model {
         // normal: texture_normalN
 
         // 1. diffuse maps
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+        collectMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", data.textures);
         // 2. specular maps
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+        collectMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", data.textures);
         // 3. normal maps
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+        collectMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", data.textures);
         // 4. height maps
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+        collectMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", data.textures);
 
-        // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        // return the extracted mesh data, the GL objects are created later on the context thread
+        return data;
     }
 
-    // checks all material textures of a given type and loads the textures if they're not loaded yet.
-    // the required info is returned as a Texture struct.
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName) {
-        vector<Texture> textures;
+    // collects the paths of all material textures of a given type, the textures themselves are loaded by loadTexture.
+    void collectMaterialTextures(aiMaterial *mat, aiTextureType type, const string &typeName, vector<Texture> &textures) {
         for (unsigned int i = 0; i < mat->GetTextureCount(type); i++) {
             aiString str;
             mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-            bool skip = false;
-            for (unsigned int j = 0; j < textures_loaded.size(); j++) {
-                if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0) {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true;  // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                    break;
-                }
-            }
-            if (!skip) {  // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-            }
+            Texture texture;
+            texture.id = 0;
+            texture.type = typeName;
+            texture.path = str.C_Str();
+            textures.push_back(texture);
+        }
+    }
+
+    // returns the texture with the given filepath, textures are shared with every other model through the TextureCache
+    Texture loadTexture(const char *path, const string &typeName) {
+        // check if this model already references the texture and if so, return it: skip acquiring it again
+        auto found = loadedIndices.find(path);
+        if (found != loadedIndices.end()) {
+            Texture texture = textures_loaded[found->second];
+            texture.type = typeName;
+            return texture;
         }
-        return textures;
+        // otherwise take a reference from the cache, which only loads the texture if no model did so before
+        Texture texture;
+        texture.id = TextureCache::shared().acquire(path, this->directory, gammaCorrection);
+        texture.type = typeName;
+        texture.path = path;
+        loadedIndices[texture.path] = textures_loaded.size();
+        textures_loaded.push_back(texture);
+        return texture;
     }
+
+    unordered_map<string, size_t> loadedIndices;  // filepath -> index into textures_loaded
 };
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma) {
@@ -189,6 +571,15 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
+    // a pre-compressed KTX2 file next to the image (or the image itself being one) is uploaded as is, no decoding needed
+    if (loadKtx2Texture(ktx2PathFor(filename), textureID)) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        return textureID;
+    }
+
     int width, height, nrComponents;
     unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
     if (data) {
@@ -200,7 +591,7 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLState::shared().bindTexture(textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
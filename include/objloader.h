@@ -0,0 +1,549 @@
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include <hash.h>
+#include <mappedfile.h>
+#include <mesh.h>
+#include <threadpool.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <glm/glm.hpp>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Native Wavefront OBJ/MTL loader, an alternative to the Assimp importer for the models we ship.
+// The file is memory mapped and cut into chunks at line boundaries that are parsed in parallel, the chunks
+// are then stitched together in file order. The result mimics Assimp with MODEL_IMPORT_FLAGS:
+//   - one mesh per object/group and material, in file order
+//   - polygons are fan triangulated, texture coordinates are flipped (FlipUVs)
+//   - smooth normals are generated for meshes without normals (GenSmoothNormals)
+//   - tangents and bitangents are computed for meshes with texture coordinates (CalcTangentSpace)
+//   - map_Kd, map_Ks, map_Bump/bump and map_Ka become texture_diffuse, _specular, _normal and _height
+// Vertices are shared between faces that use the same v/vt/vn triple, Assimp emits one vertex per face corner.
+
+// fast decimal to float conversion, handles [+-]digits[.digits][(e|E)[+-]digits]. returns the end of the number
+// (p itself when there is none)
+inline const char *parseObjFloat(const char *p, const char *end, float &out) {
+    static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int exponent = 0, digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (mantissa < 100000000000000000ull)
+            mantissa = mantissa * 10 + (*p - '0');
+        else
+            exponent++;
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (mantissa < 100000000000000000ull) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0) {
+        out = 0.0f;
+        return start;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+'))
+            negativeExponent = *e++ == '-';
+        if (e < end && *e >= '0' && *e <= '9') {
+            int value = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; e++)
+                value = std::min(value * 10 + (*e - '0'), 10000);
+            exponent += negativeExponent ? -value : value;
+            p = e;
+        }
+    }
+
+    double value = (double)mantissa;
+    if (exponent < 0)
+        value = exponent >= -22 ? value / POWERS[-exponent] : value * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        value = exponent <= 22 ? value * POWERS[exponent] : value * std::pow(10.0, exponent);
+    out = (float)(negative ? -value : value);
+    return p;
+}
+
+inline const char *parseObjInt(const char *p, const char *end, int &out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+    int value = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++)
+        value = value * 10 + (*p - '0');
+    out = negative ? -value : value;
+    return p;
+}
+
+class ObjLoader {
+   public:
+    // fills meshes with the converted contents of the OBJ file, prints the problem and returns false if it can't be read
+    static bool load(const string &path, vector<MeshData> &meshes) {
+        MappedFile file(path);
+        if (!file.isOpen()) {
+            cout << "ERROR::OBJ:: could not open " << path << endl;
+            return false;
+        }
+        string directory = path.substr(0, path.find_last_of('/'));
+        const char *data = (const char *)file.data();
+        const char *end = data + file.size();
+
+        // cut the file into chunks that end on a line break, roughly 1 MB each but a few per thread at least
+        size_t threads = ThreadPool::shared().size() + 1;
+        size_t chunkSize = std::max<size_t>(file.size() / (threads * 4) + 1, 1 << 20);
+        vector<const char *> bounds = {data};
+        while (bounds.back() < end) {
+            const char *split = bounds.back() + std::min(chunkSize, (size_t)(end - bounds.back()));
+            while (split < end && split[-1] != '\n')
+                split++;
+            bounds.push_back(split);
+        }
+        vector<Chunk> chunks(bounds.size() - 1);
+        parallelFor(chunks.size(), [&](size_t i) {
+            parseChunk(bounds[i], bounds[i + 1], chunks[i]);
+        });
+
+        // stitch the attribute arrays together, relative indices are resolved against the totals before each chunk
+        Attributes attributes;
+        size_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+        for (Chunk &chunk : chunks) {
+            chunk.positionBase = positionCount;
+            chunk.texCoordBase = texCoordCount;
+            chunk.normalBase = normalCount;
+            positionCount += chunk.positions.size() / 3;
+            texCoordCount += chunk.texCoords.size() / 2;
+            normalCount += chunk.normals.size() / 3;
+        }
+        attributes.positions.resize(positionCount * 3);
+        attributes.texCoords.resize(texCoordCount * 2);
+        attributes.normals.resize(normalCount * 3);
+        parallelFor(chunks.size(), [&](size_t i) {
+            const Chunk &chunk = chunks[i];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), attributes.positions.begin() + chunk.positionBase * 3);
+            std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), attributes.texCoords.begin() + chunk.texCoordBase * 2);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), attributes.normals.begin() + chunk.normalBase * 3);
+        });
+
+        // replay the statements in file order to find out which faces belong to which mesh
+        vector<Material> materials;
+        unordered_map<string, size_t> materialIndices;
+        vector<Part> parts;
+        string objectName;
+        size_t object = 0;  // counts the object changes, an object that shows up again later still gets a new mesh
+        size_t material = NO_MATERIAL;
+        for (size_t c = 0; c < chunks.size(); c++) {
+            Chunk &chunk = chunks[c];
+            size_t face = 0;
+            for (const Statement &statement : chunk.statements) {
+                addFaces(parts, object, material, c, face, statement.face);
+                face = statement.face;
+                if (statement.type == STATEMENT_MTLLIB) {
+                    loadMaterials(directory, statement.name, materials, materialIndices);
+                } else if (statement.type == STATEMENT_USEMTL) {
+                    auto found = materialIndices.find(statement.name);
+                    material = found == materialIndices.end() ? NO_MATERIAL : found->second;
+                } else if (statement.name != objectName) {
+                    // a new object always starts a new mesh, even if the material stays the same
+                    objectName = statement.name;
+                    object++;
+                }
+            }
+            addFaces(parts, object, material, c, face, chunk.faceSizes.size());
+        }
+        parts.erase(std::remove_if(parts.begin(), parts.end(), [](const Part &part) { return part.faces.empty(); }), parts.end());
+
+        // resolve the indices and convert every mesh independently
+        vector<MeshData> converted(parts.size());
+        vector<string> errors(parts.size());
+        parallelFor(parts.size(), [&](size_t i) {
+            buildMesh(parts[i], chunks, attributes, converted[i], errors[i]);
+            if (parts[i].material != NO_MATERIAL)
+                converted[i].textures = materials[parts[i].material].textures;
+        });
+        for (const string &error : errors) {
+            if (!error.empty()) {
+                cout << "ERROR::OBJ:: " << path << ": " << error << endl;
+                return false;
+            }
+        }
+        meshes.insert(meshes.end(), std::make_move_iterator(converted.begin()), std::make_move_iterator(converted.end()));
+        return true;
+    }
+
+   private:
+    static const size_t NO_MATERIAL = ~(size_t)0;
+    // negative (relative) indices are stored as RELATIVE + the 0-based index within their chunk
+    static const int32_t RELATIVE = -(1 << 30);
+
+    enum StatementType {
+        STATEMENT_OBJECT,  // o and g both start a new object, like in Assimp
+        STATEMENT_USEMTL,
+        STATEMENT_MTLLIB
+    };
+
+    // a statement that changes state between faces, face is the number of faces of the chunk that came before it
+    struct Statement {
+        StatementType type;
+        string name;
+        size_t face;
+    };
+
+    struct Chunk {
+        vector<float> positions, texCoords, normals;
+        vector<int32_t> corners;     // v, vt, vn per face corner, 1-based, 0 when missing
+        vector<uint32_t> faceSizes;  // corners per face
+        vector<size_t> faceOffsets;  // first corner of every face
+        vector<Statement> statements;
+        size_t positionBase = 0, texCoordBase = 0, normalBase = 0;
+    };
+
+    struct Attributes {
+        vector<float> positions, texCoords, normals;
+    };
+
+    struct FaceRange {
+        size_t chunk, begin, end;
+    };
+
+    struct Part {
+        size_t object;
+        size_t material;
+        vector<FaceRange> faces;
+    };
+
+    struct Material {
+        vector<Texture> textures;
+    };
+
+    static void addFaces(vector<Part> &parts, size_t object, size_t material, size_t chunk, size_t begin, size_t end) {
+        if (begin == end)
+            return;
+        // like Assimp a material switch only starts a new mesh if the current one already has faces
+        if (parts.empty() || parts.back().object != object || (parts.back().material != material && !parts.back().faces.empty()))
+            parts.push_back(Part{object, material, {}});
+        parts.back().material = material;
+        if (!parts.back().faces.empty() && parts.back().faces.back().chunk == chunk && parts.back().faces.back().end == begin)
+            parts.back().faces.back().end = end;
+        else
+            parts.back().faces.push_back(FaceRange{chunk, begin, end});
+    }
+
+    static const char *skipSpaces(const char *p, const char *end) {
+        while (p < end && (*p == ' ' || *p == '\t'))
+            p++;
+        return p;
+    }
+
+    static const char *lineEnd(const char *p, const char *end) {
+        const char *newline = (const char *)std::memchr(p, '\n', end - p);
+        return newline ? newline : end;
+    }
+
+    // the rest of the line without surrounding white space
+    static string restOfLine(const char *p, const char *end) {
+        p = skipSpaces(p, end);
+        while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+            end--;
+        return string(p, end);
+    }
+
+    static bool keyword(const char *p, const char *end, const char *word, size_t length) {
+        return (size_t)(end - p) > length && std::memcmp(p, word, length) == 0 && (p[length] == ' ' || p[length] == '\t');
+    }
+
+    static void parseChunk(const char *p, const char *end, Chunk &chunk) {
+        size_t positions = 0, texCoords = 0, normals = 0;
+        while (p < end) {
+            const char *eol = lineEnd(p, end);
+            p = skipSpaces(p, eol);
+            if (p + 1 < eol && p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+                // extra components (w or vertex colors) are ignored
+                p += 2;
+                for (int i = 0; i < 3; i++) {
+                    float value;
+                    p = parseObjFloat(skipSpaces(p, eol), eol, value);
+                    chunk.positions.push_back(value);
+                }
+                positions++;
+            } else if (p + 2 < eol && p[0] == 'v' && p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+                p += 3;
+                for (int i = 0; i < 2; i++) {
+                    float value;
+                    p = parseObjFloat(skipSpaces(p, eol), eol, value);
+                    chunk.texCoords.push_back(value);
+                }
+                texCoords++;
+            } else if (p + 2 < eol && p[0] == 'v' && p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+                p += 3;
+                for (int i = 0; i < 3; i++) {
+                    float value;
+                    p = parseObjFloat(skipSpaces(p, eol), eol, value);
+                    chunk.normals.push_back(value);
+                }
+                normals++;
+            } else if (p + 1 < eol && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+                p += 2;
+                size_t first = chunk.corners.size();
+                const size_t counts[3] = {positions, texCoords, normals};
+                while (true) {
+                    p = skipSpaces(p, eol);
+                    if (p >= eol || *p < '+' || *p > '9')
+                        break;
+                    int32_t corner[3] = {0, 0, 0};
+                    for (int k = 0; k < 3; k++) {
+                        int value = 0;
+                        p = parseObjInt(p, eol, value);
+                        // relative indices count back from the current position, which is only known per chunk here
+                        corner[k] = value < 0 ? RELATIVE + (int32_t)counts[k] + value : value;
+                        if (p >= eol || *p != '/')
+                            break;
+                        p++;
+                    }
+                    chunk.corners.insert(chunk.corners.end(), corner, corner + 3);
+                }
+                size_t size = (chunk.corners.size() - first) / 3;
+                if (size >= 3) {
+                    chunk.faceOffsets.push_back(first / 3);
+                    chunk.faceSizes.push_back((uint32_t)size);
+                } else {
+                    // points and degenerate faces aren't drawn as triangles
+                    chunk.corners.resize(first);
+                }
+            } else if (keyword(p, eol, "usemtl", 6)) {
+                chunk.statements.push_back(Statement{STATEMENT_USEMTL, restOfLine(p + 6, eol), chunk.faceSizes.size()});
+            } else if (keyword(p, eol, "mtllib", 6)) {
+                chunk.statements.push_back(Statement{STATEMENT_MTLLIB, restOfLine(p + 6, eol), chunk.faceSizes.size()});
+            } else if (p + 1 < eol && (p[0] == 'o' || p[0] == 'g') && (p[1] == ' ' || p[1] == '\t')) {
+                chunk.statements.push_back(Statement{STATEMENT_OBJECT, restOfLine(p + 2, eol), chunk.faceSizes.size()});
+            }
+            p = eol + 1;
+        }
+    }
+
+    // turns a stored index into a 0-based index into the stitched arrays, -1 when missing or out of range
+    static int64_t resolve(int32_t index, size_t base, size_t count) {
+        int64_t resolved;
+        if (index == 0)
+            return -1;
+        if (index < 0)
+            resolved = (int64_t)base + (index - RELATIVE);
+        else
+            resolved = (int64_t)index - 1;
+        return resolved >= 0 && resolved < (int64_t)count ? resolved : -2;
+    }
+
+    static void buildMesh(const Part &part, const vector<Chunk> &chunks, const Attributes &attributes, MeshData &mesh, string &error) {
+        size_t positionCount = attributes.positions.size() / 3, texCoordCount = attributes.texCoords.size() / 2, normalCount = attributes.normals.size() / 3;
+
+        // open addressing table from a v/vt/vn triple to its vertex
+        size_t cornerCount = 0;
+        for (const FaceRange &range : part.faces)
+            for (size_t f = range.begin; f < range.end; f++)
+                cornerCount += chunks[range.chunk].faceSizes[f];
+        size_t capacity = 1;
+        while (capacity < cornerCount * 2)
+            capacity <<= 1;
+        struct Slot {
+            int64_t key[3];
+            unsigned int vertex;
+        };
+        vector<Slot> table(capacity, Slot{{-1, -1, -1}, ~0u});
+        vector<int64_t> positionOf;  // position index of every vertex, smooth normals are shared per position
+        bool missingNormals = false, hasTexCoords = false;
+
+        vector<unsigned int> polygon;
+        for (const FaceRange &range : part.faces) {
+            const Chunk &chunk = chunks[range.chunk];
+            for (size_t f = range.begin; f < range.end; f++) {
+                polygon.clear();
+                const int32_t *corner = &chunk.corners[chunk.faceOffsets[f] * 3];
+                for (uint32_t c = 0; c < chunk.faceSizes[f]; c++, corner += 3) {
+                    int64_t key[3] = {resolve(corner[0], chunk.positionBase, positionCount), resolve(corner[1], chunk.texCoordBase, texCoordCount),
+                                      resolve(corner[2], chunk.normalBase, normalCount)};
+                    if (key[0] < 0 || key[1] == -2 || key[2] == -2) {
+                        error = "face index out of range";
+                        return;
+                    }
+                    uint64_t hash = hashMix((uint64_t)key[0] * 0x9e3779b97f4a7c15ull ^ (uint64_t)(key[1] + 1) * 0xc2b2ae3d27d4eb4full ^ (uint64_t)(key[2] + 1));
+                    size_t slot = hash & (capacity - 1);
+                    while (table[slot].vertex != ~0u && std::memcmp(table[slot].key, key, sizeof(key)) != 0)
+                        slot = (slot + 1) & (capacity - 1);
+                    if (table[slot].vertex == ~0u) {
+                        Vertex vertex = {};
+                        vertex.Position = glm::vec3(attributes.positions[key[0] * 3], attributes.positions[key[0] * 3 + 1], attributes.positions[key[0] * 3 + 2]);
+                        if (key[1] >= 0) {
+                            vertex.TexCoords = glm::vec2(attributes.texCoords[key[1] * 2], 1.0f - attributes.texCoords[key[1] * 2 + 1]);
+                            hasTexCoords = true;
+                        }
+                        if (key[2] >= 0)
+                            vertex.Normal = glm::vec3(attributes.normals[key[2] * 3], attributes.normals[key[2] * 3 + 1], attributes.normals[key[2] * 3 + 2]);
+                        else
+                            missingNormals = true;
+                        std::memcpy(table[slot].key, key, sizeof(key));
+                        table[slot].vertex = (unsigned int)mesh.vertices.size();
+                        mesh.vertices.push_back(vertex);
+                        positionOf.push_back(key[0]);
+                    }
+                    polygon.push_back(table[slot].vertex);
+                }
+                // fan triangulation
+                for (size_t i = 2; i < polygon.size(); i++) {
+                    mesh.indices.push_back(polygon[0]);
+                    mesh.indices.push_back(polygon[i - 1]);
+                    mesh.indices.push_back(polygon[i]);
+                }
+            }
+        }
+
+        if (missingNormals)
+            generateNormals(mesh, positionOf);
+        if (hasTexCoords)
+            generateTangents(mesh);
+    }
+
+    // sums the normalized face normals over every vertex that shares a position, like Assimp's GenSmoothNormals
+    static void generateNormals(MeshData &mesh, const vector<int64_t> &positionOf) {
+        unordered_map<int64_t, glm::vec3> sums;
+        sums.reserve(mesh.vertices.size());
+        for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+            glm::vec3 a = mesh.vertices[mesh.indices[t]].Position, b = mesh.vertices[mesh.indices[t + 1]].Position, c = mesh.vertices[mesh.indices[t + 2]].Position;
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            float length = glm::length(normal);
+            if (length > 0.0f)
+                normal /= length;
+            for (int k = 0; k < 3; k++)
+                sums[positionOf[mesh.indices[t + k]]] += normal;
+        }
+        for (size_t v = 0; v < mesh.vertices.size(); v++) {
+            glm::vec3 sum = sums[positionOf[v]];
+            float length = glm::length(sum);
+            mesh.vertices[v].Normal = length > 0.0f ? sum / length : glm::vec3(0.0f);
+        }
+    }
+
+    // per face tangents from the texture coordinates, accumulated per vertex and made orthogonal to the normal
+    static void generateTangents(MeshData &mesh) {
+        vector<glm::vec3> tangents(mesh.vertices.size(), glm::vec3(0.0f)), bitangents(mesh.vertices.size(), glm::vec3(0.0f));
+        for (size_t t = 0; t + 2 < mesh.indices.size(); t += 3) {
+            const Vertex &a = mesh.vertices[mesh.indices[t]], &b = mesh.vertices[mesh.indices[t + 1]], &c = mesh.vertices[mesh.indices[t + 2]];
+            glm::vec3 edge1 = b.Position - a.Position, edge2 = c.Position - a.Position;
+            glm::vec2 uv1 = b.TexCoords - a.TexCoords, uv2 = c.TexCoords - a.TexCoords;
+            float determinant = uv1.x * uv2.y - uv2.x * uv1.y;
+            if (std::abs(determinant) < 1e-20f)
+                continue;
+            float r = 1.0f / determinant;
+            glm::vec3 tangent = (edge1 * uv2.y - edge2 * uv1.y) * r;
+            glm::vec3 bitangent = (edge2 * uv1.x - edge1 * uv2.x) * r;
+            for (int k = 0; k < 3; k++) {
+                tangents[mesh.indices[t + k]] += tangent;
+                bitangents[mesh.indices[t + k]] += bitangent;
+            }
+        }
+        for (size_t v = 0; v < mesh.vertices.size(); v++) {
+            Vertex &vertex = mesh.vertices[v];
+            glm::vec3 tangent = tangents[v] - vertex.Normal * glm::dot(vertex.Normal, tangents[v]);
+            glm::vec3 bitangent = bitangents[v] - vertex.Normal * glm::dot(vertex.Normal, bitangents[v]);
+            float tangentLength = glm::length(tangent), bitangentLength = glm::length(bitangent);
+            vertex.Tangent = tangentLength > 0.0f ? tangent / tangentLength : glm::vec3(0.0f);
+            vertex.Bitangent = bitangentLength > 0.0f ? bitangent / bitangentLength : glm::vec3(0.0f);
+        }
+    }
+
+    // texture file of a map_ statement, options like -bm 0.5 or -s 1 1 1 in front of it are skipped
+    static string mapFile(const string &arguments) {
+        std::istringstream tokens(arguments);
+        string token, file;
+        bool option = false;
+        while (tokens >> token) {
+            if (token[0] == '-' && token.size() > 1 && !std::isdigit((unsigned char)token[1]) && token[1] != '.') {
+                option = true;
+                continue;
+            }
+            float number;
+            if (option && (parseObjFloat(token.data(), token.data() + token.size(), number) == token.data() + token.size() || token == "on" || token == "off"))
+                continue;
+            option = false;
+            file = file.empty() ? token : file + ' ' + token;
+        }
+        return file;
+    }
+
+    static void loadMaterials(const string &directory, const string &library, vector<Material> &materials, unordered_map<string, size_t> &indices) {
+        std::ifstream file(directory + '/' + library);
+        if (!file) {
+            cout << "WARNING::OBJ:: could not open material library " << directory + '/' + library << endl;
+            return;
+        }
+        // the texture order matches Model::processMesh: diffuse, specular, normal, height
+        static const char *const MAPS[4][2] = {{"map_Kd", "texture_diffuse"}, {"map_Ks", "texture_specular"}, {"map_Bump", "texture_normal"}, {"map_Ka", "texture_height"}};
+        vector<vector<string>> maps;
+        size_t current = NO_MATERIAL;
+        auto finish = [&]() {
+            if (current == NO_MATERIAL)
+                return;
+            for (int m = 0; m < 4; m++) {
+                for (const string &path : maps[m]) {
+                    Texture texture;
+                    texture.id = 0;
+                    texture.type = MAPS[m][1];
+                    texture.path = path;
+                    materials[current].textures.push_back(texture);
+                }
+            }
+        };
+        string line;
+        while (std::getline(file, line)) {
+            const char *p = skipSpaces(line.data(), line.data() + line.size()), *end = line.data() + line.size();
+            if (keyword(p, end, "newmtl", 6)) {
+                finish();
+                string name = restOfLine(p + 6, end);
+                auto existing = indices.find(name);
+                if (existing != indices.end()) {
+                    current = existing->second;
+                    materials[current].textures.clear();
+                } else {
+                    current = materials.size();
+                    indices[name] = current;
+                    materials.push_back(Material());
+                }
+                maps.assign(4, vector<string>());
+                continue;
+            }
+            if (current == NO_MATERIAL)
+                continue;
+            for (int m = 0; m < 4; m++) {
+                size_t length = std::strlen(MAPS[m][0]);
+                // bump is the older spelling of map_Bump
+                bool bump = m == 2 && (keyword(p, end, "bump", 4) || keyword(p, end, "map_bump", 8));
+                if (keyword(p, end, MAPS[m][0], length) || bump) {
+                    size_t skip = bump ? (p[0] == 'b' ? 4 : 8) : length;
+                    string path = mapFile(restOfLine(p + skip, end));
+                    if (!path.empty())
+                        maps[m].push_back(path);
+                }
+            }
+        }
+        finish();
+    }
+};
+
+#endif
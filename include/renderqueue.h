@@ -0,0 +1,276 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <glad/glad.h>
+#include <glstate.h>
+#include <instancebuffer.h>
+#include <mesh.h>
+#include <meshbuffer.h>
+#include <shader.h>
+#include <shaderuniforms.h>
+#include <uniformbuffers.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// passes in the order they're drawn
+enum RenderPass {
+    RENDER_PASS_OPAQUE,      // front to back with depth writes
+    RENDER_PASS_TRANSPARENT  // back to front, alpha blended without depth writes
+};
+
+// widths of the sort key parts, 64 bits in total. opaque keys are pass | shader | material | VAO | depth, so state
+// changes are rare and each state bucket draws front to back. transparent keys are pass | reversed depth | shader |
+// material | VAO, back to front comes first there
+const unsigned int RENDER_KEY_PASS_BITS = 2;
+const unsigned int RENDER_KEY_SHADER_BITS = 10;
+const unsigned int RENDER_KEY_MATERIAL_BITS = 14;
+const unsigned int RENDER_KEY_VAO_BITS = 14;
+const unsigned int RENDER_KEY_DEPTH_BITS = 24;
+
+// one draw: a mesh, a multi-draw of meshes that share its textures, or every instance of a mesh
+struct RenderCommand {
+    Shader *shader = NULL;
+    Mesh *mesh = NULL;                      // textures and VAO, and what gets drawn unless buffer or instances is set
+    const MeshBuffer *buffer = NULL;        // draws commands [first, first + count) of buffer's draw order
+    size_t first = 0, count = 0;
+    const InstanceBuffer *instances = NULL;  // draws every instance, the transforms come from there
+    unsigned int transform = 0;             // model matrix, see RenderQueue::addTransform
+    glm::vec3 center = glm::vec3(0.0f);     // world space, the depth of the draw is measured to it
+    RenderPass pass = RENDER_PASS_OPAQUE;
+};
+
+// what gets sorted: the key and the command it stands for
+struct RenderItem {
+    uint64_t key;
+    uint32_t command;
+};
+
+// The sorted draws of a RenderQueue, recorded once per frame and replayed for every view. A replay only walks the
+// commands and issues what changed, the variant lookups, keys and the sort were done when it was recorded. Opaque
+// draws keep the front to back order of the recording view, only transparent ones are put back to front again for
+// the view they're replayed for. Holds the same pointers as the queue it was recorded from.
+class CommandList {
+   public:
+    // draws the commands, depths are measured from viewPosition. leaves depth writes on and blending off
+    void replay(const glm::vec3 &viewPosition) {
+        draw(viewPosition, 1);
+    }
+
+    // binds the view block of view and draws the commands for it, the uniforms have to be uploaded
+    void replay(SceneUniforms &uniforms, size_t view) {
+        uniforms.bindView(view);
+        replay(uniforms.views[view].viewPos);
+    }
+
+    // draws the commands once for every view of the multi-view block, each draw repeats its instances per view.
+    // the commands have to be recorded with SHADER_MULTI_VIEW variants and drawn into a LayeredFramebuffer.
+    // transparent ones are ordered for the first view
+    void replayMultiView(const SceneUniforms &uniforms) {
+        draw(uniforms.views[0].viewPos, (unsigned int)uniforms.multiViewCount());
+    }
+
+    size_t size() const {
+        return commands.size();
+    }
+
+   private:
+    friend class RenderQueue;
+
+    std::vector<RenderCommand> commands;  // in key order
+    std::vector<glm::mat4> transforms;
+    size_t transparentStart = 0;             // the transparent commands come last
+    glm::vec3 orderedFor = glm::vec3(0.0f);  // the view position they're ordered for
+
+    void draw(const glm::vec3 &viewPosition, unsigned int viewCount) {
+        orderTransparent(viewPosition);
+        Shader *shader = NULL;
+        unsigned int transform = 0;
+        bool transformSet = false, transparent = false;
+        for (size_t i = 0; i < commands.size(); i++) {
+            const RenderCommand &command = commands[i];
+            if (i == 0 || (command.pass == RENDER_PASS_TRANSPARENT) != transparent) {
+                transparent = command.pass == RENDER_PASS_TRANSPARENT;
+                setPassState(transparent);
+            }
+            if (command.shader != shader) {
+                shader = command.shader;
+                shader->use();
+                transformSet = false;
+            }
+            if (command.instances != NULL) {
+                command.instances->bind();
+                command.mesh->DrawInstanced(*shader, command.instances->size() * viewCount);
+                continue;
+            }
+            if (!transformSet || command.transform != transform) {
+                transform = command.transform;
+                transformSet = true;
+                shader->setmatrix4(shaderuniforms::multilight_vs::MODEL, transforms[transform]);
+            }
+            if (command.buffer != NULL) {
+                command.buffer->bind();
+                command.mesh->Bind(*shader);
+                command.buffer->multiDraw(command.first, command.count, viewCount);
+            } else if (viewCount > 1) {
+                command.mesh->DrawInstanced(*shader, viewCount);
+            } else {
+                command.mesh->Draw(*shader);
+            }
+        }
+        if (transparent)
+            setPassState(false);
+    }
+
+    static void setPassState(bool transparent) {
+        GLState &state = GLState::shared();
+        state.setEnabled(GL_BLEND, transparent);
+        if (transparent)
+            state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        state.depthMask(!transparent);
+    }
+
+    void orderTransparent(const glm::vec3 &viewPosition) {
+        if (viewPosition == orderedFor || commands.size() - transparentStart < 2)
+            return;
+        orderedFor = viewPosition;
+        std::stable_sort(commands.begin() + transparentStart, commands.end(), [&](const RenderCommand &a, const RenderCommand &b) {
+            return glm::dot(a.center - viewPosition, a.center - viewPosition) > glm::dot(b.center - viewPosition, b.center - viewPosition);
+        });
+    }
+};
+
+// Deferred drawing: the scene submits RenderCommands, execute() sorts them by a 64 bit key (see RENDER_KEY_*) and
+// draws them in that order. Submission order doesn't matter anymore, draws that share a program, textures or a VAO
+// end up next to each other so GLState can drop the binds in between, opaque draws go front to back for early depth
+// rejection and transparent ones back to front so they blend correctly. record() keeps the sorted draws in a
+// CommandList to replay them for several views.
+// Shader, Mesh, MeshBuffer and InstanceBuffer pointers are kept until the next begin().
+class RenderQueue {
+   public:
+    // drops last frame's commands, depths are measured from viewPosition
+    void begin(const glm::vec3 &viewPosition) {
+        this->viewPosition = viewPosition;
+        commands.clear();
+        transforms.clear();
+        shaderIds.clear();
+        materialIds.clear();
+        vaoIds.clear();
+    }
+
+    // stores a model matrix for the commands that follow, returns the index for RenderCommand::transform
+    unsigned int addTransform(const glm::mat4 &model) {
+        transforms.push_back(model);
+        return (unsigned int)transforms.size() - 1;
+    }
+
+    void submit(const RenderCommand &command) {
+        commands.push_back(command);
+    }
+
+    // sorts everything submitted since begin() into list, for views near the one given to begin()
+    void record(CommandList &list) {
+        sort();
+        list.commands.resize(items.size());
+        for (size_t i = 0; i < items.size(); i++)
+            list.commands[i] = commands[items[i].command];
+        list.transforms = transforms;
+        list.transparentStart = list.commands.size();
+        while (list.transparentStart > 0 && list.commands[list.transparentStart - 1].pass == RENDER_PASS_TRANSPARENT)
+            list.transparentStart--;
+        list.orderedFor = viewPosition;
+    }
+
+    // sorts and draws everything submitted since begin(). leaves depth writes on and blending off
+    void execute() {
+        record(executed);
+        executed.replay(viewPosition);
+    }
+
+    size_t size() const {
+        return commands.size();
+    }
+
+   private:
+    glm::vec3 viewPosition = glm::vec3(0.0f);
+    std::vector<RenderCommand> commands;
+    std::vector<glm::mat4> transforms;
+    std::vector<RenderItem> items, scratch;
+    CommandList executed;
+    // small ids for the key in order of first appearance so they fit their bits, reset by begin() so they only
+    // have to cover one frame's draws
+    std::unordered_map<uint64_t, uint64_t> shaderIds, materialIds, vaoIds;
+
+    void sort() {
+        items.resize(commands.size());
+        for (size_t i = 0; i < commands.size(); i++)
+            items[i] = {keyFor(commands[i]), (uint32_t)i};
+        radixSort(items, scratch);
+    }
+
+    uint64_t keyFor(const RenderCommand &command) {
+        uint64_t shader = compactId(shaderIds, command.shader->serial, RENDER_KEY_SHADER_BITS);
+        uint64_t material = compactId(materialIds, materialHash(*command.mesh), RENDER_KEY_MATERIAL_BITS);
+        uint64_t vao = compactId(vaoIds, command.mesh->VAO, RENDER_KEY_VAO_BITS);
+        uint64_t depth = depthBits(glm::length(command.center - viewPosition));
+        uint64_t state = (shader << (RENDER_KEY_MATERIAL_BITS + RENDER_KEY_VAO_BITS)) | (material << RENDER_KEY_VAO_BITS) | vao;
+        const unsigned int stateBits = RENDER_KEY_SHADER_BITS + RENDER_KEY_MATERIAL_BITS + RENDER_KEY_VAO_BITS;
+        uint64_t key = (uint64_t)command.pass << (stateBits + RENDER_KEY_DEPTH_BITS);
+        if (command.pass == RENDER_PASS_TRANSPARENT)
+            return key | (((1ull << RENDER_KEY_DEPTH_BITS) - 1 - depth) << stateBits) | state;
+        return key | (state << RENDER_KEY_DEPTH_BITS) | depth;
+    }
+
+    // ids past the width of their key part share the last one, which only costs a few state changes
+    static uint64_t compactId(std::unordered_map<uint64_t, uint64_t> &ids, uint64_t value, unsigned int bits) {
+        uint64_t id = ids.emplace(value, ids.size()).first->second;
+        uint64_t max = (1ull << bits) - 1;
+        return id < max ? id : max;
+    }
+
+    // the texture names and types of a mesh, meshes with equal hashes bind the same textures
+    static uint64_t materialHash(const Mesh &mesh) {
+        uint64_t hash = 14695981039346656037ull;  // FNV-1a
+        for (const Texture &texture : mesh.textures) {
+            hash = (hash ^ texture.id) * 1099511628211ull;
+            for (char c : texture.type)
+                hash = (hash ^ (unsigned char)c) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // the bits of a non negative float sort like the float itself, the top RENDER_KEY_DEPTH_BITS of them are plenty
+    static uint64_t depthBits(float depth) {
+        uint32_t bits;
+        memcpy(&bits, &depth, sizeof(bits));
+        return (bits & 0x7FFFFFFFu) >> (31 - RENDER_KEY_DEPTH_BITS);
+    }
+
+    // least significant byte first, stable. bytes every key shares are skipped
+    static void radixSort(std::vector<RenderItem> &items, std::vector<RenderItem> &scratch) {
+        scratch.resize(items.size());
+        for (unsigned int shift = 0; shift < 64; shift += 8) {
+            size_t counts[256] = {};
+            for (const RenderItem &item : items)
+                counts[(item.key >> shift) & 0xFF]++;
+            if (items.empty() || counts[(items[0].key >> shift) & 0xFF] == items.size())
+                continue;
+            size_t offset = 0;
+            for (size_t &count : counts) {
+                size_t next = offset + count;
+                count = offset;
+                offset = next;
+            }
+            for (const RenderItem &item : items)
+                scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+            items.swap(scratch);
+        }
+    }
+};
+
+#endif
@@ -1,8 +1,15 @@
 #ifndef SHADER_H
 #define SHADER_H
 
+#include <embeddedshaders.h>
 #include <glad/glad.h>
+#include <glstate.h>
+#include <hash.h>
+#include <mappedfile.h>
+#include <shadercache.h>
 
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -10,112 +17,467 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// GL_KHR_parallel_shader_compile, glad only carries the core profile
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+// SHADER_BUILD_ASYNC returns from the constructor right after glLinkProgram, poll ready() until the program can be used
+enum ShaderBuild {
+    SHADER_BUILD_NOW,
+    SHADER_BUILD_ASYNC
+};
+
+// uniform name hashed at compile time, e.g. static constexpr UniformName VIEW_POS("viewPos");
+// setting a uniform through it costs one hash table lookup and no string handling
+struct UniformName {
+    uint64_t hash;
+    const char *name;
+
+    constexpr explicit UniformName(const char *name) : hash(hashString(name)), name(name) {}
+};
+
+// precompiled SPIR-V module (ARB_gl_spirv, core in 4.6) and the specialization constants it's built with
+struct SpecializationConstant {
+    unsigned int id;     // layout (constant_id = id)
+    unsigned int value;  // bit pattern of the int, uint, float or bool
+};
+
+struct SpirvModule {
+    std::string path;
+    std::vector<SpecializationConstant> constants;
+};
+
+// uniform location fixed in the shader with layout (location = N)
+struct UniformLocation {
+    const char *name;
+    int location;
+};
 
 class Shader {
    public:
     // program id
     unsigned int ID;
+    // true when the program came out of the binary cache instead of the compiler
+    bool loadedFromCache = false;
+    // false when compiling or linking failed, and while an async build hasn't finished
+    bool linked = false;
+    // unique per Shader, unlike ID which GL hands out again after a program is deleted. lets other objects cache
+    // what they resolved against this program (see Mesh::Draw)
+    const uint64_t serial = nextSerial();
+
+    // constructor, defines are inserted after the #version line of both stages (e.g. "#define NR_POINT_LIGHTS 2\n")
+    Shader(const char *vertexPath, const char *fragmentPath, const std::string &defines = "", ShaderBuild mode = SHADER_BUILD_NOW) {
+        build(injectDefines(readSource(vertexPath), defines), injectDefines(readSource(fragmentPath), defines), mode);
+    }
+
+    // constructor for SPIR-V modules, which skip the driver's GLSL front end. drivers don't have to report uniform
+    // names for SPIR-V programs (Mesa doesn't), so names missing after linking resolve through uniformLocations
+    Shader(const SpirvModule &vertex, const SpirvModule &fragment, const std::vector<UniformLocation> &uniformLocations = {},
+           ShaderBuild mode = SHADER_BUILD_NOW)
+        : declaredLocations(uniformLocations) {
+        MappedFile vertexModule(vertex.path), fragmentModule(fragment.path);
+        if (!vertexModule.isOpen() || !fragmentModule.isOpen()) {
+            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << '\n';
+            ID = glCreateProgram();
+            return;
+        }
+        uint64_t key = hashCombine(specializationHash(vertexModule, vertex.constants), specializationHash(fragmentModule, fragment.constants));
+        if (loadCached(ShaderCache::programKey(key)))
+            return;
+        pendingVertex = specialize(GL_VERTEX_SHADER, vertexModule, vertex.constants);
+        pendingFragment = specialize(GL_FRAGMENT_SHADER, fragmentModule, fragment.constants);
+        link();
+        if (mode == SHADER_BUILD_NOW)
+            finishBuild();
+    }
+
+    // source of a shader file: the copy tools/shaderembed compiled in (include/embeddedshaders.h), so startup reads no
+    // files. the file itself is read when it wasn't embedded, when sourcesFromDisk() is set (editing shaders without
+    // running shaderembed again) or after overrideFromDisk(path), which hot reload calls for files that changed
+    static std::string readSource(const char *path) {
+        std::string key = normalizedPath(path);
+        if (!sourcesFromDisk() && diskOverrides().count(key) == 0) {
+            for (const EmbeddedShader &shader : EMBEDDED_SHADERS) {
+                if (key == shader.path)
+                    return std::string(shader.source);
+            }
+        }
 
-    // constructor
-    Shader(const char *vertexPath, const char *fragmentPath) {
         // retrieving source code from file path
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
+        std::string code;
+        std::ifstream shaderFile;
         // ensure ifstream objects can throw exceptions
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        shaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
         try {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        } catch (const std::ifstream::failure e) {
-            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << '\n';
+            shaderFile.open(path);
+            std::stringstream shaderStream;
+            shaderStream << shaderFile.rdbuf();
+            shaderFile.close();
+            code = shaderStream.str();
+        } catch (const std::ifstream::failure &e) {
+            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ " << path << '\n';
         }
-        const char *vShaderCode = vertexCode.c_str();
-        const char *fShaderCode = fragmentCode.c_str();
+        return code;
+    }
+
+    static bool &sourcesFromDisk() {
+        static bool value = false;
+        return value;
+    }
+
+    static void overrideFromDisk(const std::string &path) {
+        diskOverrides().insert(normalizedPath(path));
+    }
+
+    // where tools/spirvcompile puts the module of a GLSL file: shaders/x.fs -> shaders/spirv/x.fs.spv, or
+    // shaders/spirv/x.fs.<variant>.spv for a module compiled with extra defines
+    static std::string spirvPathFor(const std::string &glslPath, const std::string &variant = "") {
+        size_t slash = glslPath.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "" : glslPath.substr(0, slash + 1);
+        std::string name = slash == std::string::npos ? glslPath : glslPath.substr(slash + 1);
+        return directory + "spirv/" + name + (variant.empty() ? "" : "." + variant) + ".spv";
+    }
+
+    // activate shader, nothing happens when it already is
+    void use() {
+        GLState::shared().useProgram(ID);
+    }
+
+    // true once the program is built (linked or not). an async build is finished here: without
+    // parallel compile support the first call waits for the compiler, with it no call ever blocks
+    bool ready() {
+        if (!building())
+            return true;
+        if (parallelCompileSupported()) {
+            int done = 0;
+            glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done)
+                return false;
+        }
+        finishBuild();
+        return true;
+    }
+
+    bool building() const {
+        return pendingVertex != 0;
+    }
+
+    // deletes the program, and the shader objects of a build that is still running
+    void release() {
+        if (building()) {
+            glDeleteShader(pendingVertex);
+            glDeleteShader(pendingFragment);
+            pendingVertex = pendingFragment = 0;
+        }
+        GLState::shared().forgetProgram(ID);
+        glDeleteProgram(ID);
+        ID = 0;
+        linked = false;
+    }
+
+    // GL_KHR_parallel_shader_compile (or the ARB version) lets the driver compile on its own threads and report completion
+    static bool parallelCompileSupported() {
+        static const bool supported = []() {
+            int count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+            for (int i = 0; i < count; i++) {
+                const char *extension = (const char *)glGetStringi(GL_EXTENSIONS, i);
+                if (extension && (std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0 ||
+                                  std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0))
+                    return true;
+            }
+            return false;
+        }();
+        return supported;
+    }
+
+    // location of an active uniform, -1 if the program doesn't use it (setting -1 is a no-op in GL).
+    // resolve locations once and keep them, the int overloads of the setters don't touch any names
+    int uniformLocation(const std::string &name) const {
+        auto it = uniforms.find(hashString(name));
+        if (it == uniforms.end())
+            return -1;
+        // another name with the same hash, ask GL instead
+        if (it->second.name != name)
+            return glGetUniformLocation(ID, name.c_str());
+        return it->second.location;
+    }
+    int uniformLocation(UniformName name) const {
+        auto it = uniforms.find(name.hash);
+        return it == uniforms.end() ? -1 : it->second.location;
+    }
+
+    // functions for uniforms
+    void setBool(int location, bool value) const {
+        glUniform1i(location, (int)value);
+    }
+    void set1i(int location, int value) const {
+        glUniform1i(location, value);
+    }
+    void set1f(int location, float value) const {
+        glUniform1f(location, value);
+    }
+    void set2f(int location, glm::vec2 values) const {
+        glUniform2f(location, values.x, values.y);
+    }
+    void set3f(int location, glm::vec3 values) const {
+        glUniform3f(location, values.x, values.y, values.z);
+    }
+    void set3f(int location, float x, float y, float z) const {
+        glUniform3f(location, x, y, z);
+    }
+    void setmatrix4(int location, glm::mat4 values) const {
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(values));
+    }
+
+    // points a sampler at a texture unit, skipped when the program already has that value from an earlier call.
+    // the program has to be in use. set1i on the same location goes around this, don't mix the two for a sampler
+    void setSampler(int location, int unit) const {
+        if (location < 0)
+            return;
+        if ((size_t)location >= samplerUnits.size())
+            samplerUnits.resize(location + 1, -1);
+        if (samplerUnits[location] == unit)
+            return;
+        samplerUnits[location] = unit;
+        glUniform1i(location, unit);
+    }
+
+    void setBool(UniformName name, bool value) const {
+        setBool(uniformLocation(name), value);
+    }
+    void set1i(UniformName name, int value) const {
+        set1i(uniformLocation(name), value);
+    }
+    void set1f(UniformName name, float value) const {
+        set1f(uniformLocation(name), value);
+    }
+    void set2f(UniformName name, glm::vec2 values) const {
+        set2f(uniformLocation(name), values);
+    }
+    void set3f(UniformName name, glm::vec3 values) const {
+        set3f(uniformLocation(name), values);
+    }
+    void set3f(UniformName name, float x, float y, float z) const {
+        set3f(uniformLocation(name), x, y, z);
+    }
+    void setmatrix4(UniformName name, glm::mat4 values) const {
+        setmatrix4(uniformLocation(name), values);
+    }
 
-        // compile shaders
-        unsigned int vertex, fragment;
+    void setBool(const std::string &name, bool value) const {
+        setBool(uniformLocation(name), value);
+    }
+    void set1i(const std::string &name, int value) const {
+        set1i(uniformLocation(name), value);
+    }
+    void set1f(const std::string &name, float value) const {
+        set1f(uniformLocation(name), value);
+    }
+    void set2f(const std::string &name, glm::vec2 values) const {
+        set2f(uniformLocation(name), values);
+    }
+    void set3f(const std::string &name, glm::vec3 values) const {
+        set3f(uniformLocation(name), values);
+    }
+    void set3f(const std::string &name, float x, float y, float z) const {
+        set3f(uniformLocation(name), x, y, z);
+    }
+    void setmatrix4(const std::string &name, glm::mat4 values) const {
+        setmatrix4(uniformLocation(name), values);
+    }
+
+    // number of active uniforms found at link time, array elements count individually
+    size_t uniformCount() const {
+        return uniforms.size();
+    }
+
+   private:
+    static std::unordered_set<std::string> &diskOverrides() {
+        static std::unordered_set<std::string> paths;
+        return paths;
+    }
+
+    static std::string normalizedPath(const std::string &path) {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    // shader objects of a build that hasn't been checked yet, 0 when there is none
+    unsigned int pendingVertex = 0, pendingFragment = 0;
+    uint64_t cacheKey = 0;
+
+    // loads the program from the binary cache or compiles and links it, then reflects its uniforms
+    void build(const std::string &vertexCode, const std::string &fragmentCode, ShaderBuild mode) {
+        if (loadCached(ShaderCache::programKey(vertexCode, fragmentCode)))
+            return;
+        startCompile(vertexCode.c_str(), fragmentCode.c_str());
+        if (mode == SHADER_BUILD_NOW)
+            finishBuild();
+    }
+
+    // true when the program came out of the binary cache, otherwise ID is a fresh program to build into
+    bool loadCached(uint64_t key) {
+        cacheKey = key;
+        ID = glCreateProgram();
+        loadedFromCache = ShaderCache::load(ID, key);
+        if (loadedFromCache) {
+            linked = true;
+            reflectUniforms();
+            return true;
+        }
+        // a rejected binary can leave the program in a failed state, start over with a fresh one
+        glDeleteProgram(ID);
+        ID = glCreateProgram();
+        return false;
+    }
+
+    // issues compile and link without asking for any status, so the driver is free to work in the background
+    void startCompile(const char *vShaderCode, const char *fShaderCode) {
+        pendingVertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pendingVertex, 1, &vShaderCode, NULL);
+        glCompileShader(pendingVertex);
+
+        pendingFragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pendingFragment, 1, &fShaderCode, NULL);
+        glCompileShader(pendingFragment);
+        link();
+    }
+
+    void link() {
+        glAttachShader(ID, pendingVertex);
+        glAttachShader(ID, pendingFragment);
+        // ask for a binary the cache can store
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(ID);
+    }
+
+    // glSpecializeShader takes the place of glCompileShader, failures show up in the compile status all the same
+    static unsigned int specialize(GLenum stage, const MappedFile &module, const std::vector<SpecializationConstant> &constants) {
+        unsigned int shader = glCreateShader(stage);
+        glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, module.data(), (GLsizei)module.size());
+        std::vector<GLuint> ids, values;
+        for (const SpecializationConstant &constant : constants) {
+            ids.push_back(constant.id);
+            values.push_back(constant.value);
+        }
+        glSpecializeShader(shader, "main", (GLuint)constants.size(), ids.data(), values.data());
+        return shader;
+    }
+
+    static uint64_t specializationHash(const MappedFile &module, const std::vector<SpecializationConstant> &constants) {
+        uint64_t hash = hashBytes(module.data(), module.size());
+        for (const SpecializationConstant &constant : constants)
+            hash = hashCombine(hash, (uint64_t)constant.id << 32 | constant.value);
+        return hash;
+    }
+
+    // checks the results of startCompile, stores the binary and reflects the uniforms
+    void finishBuild() {
         int success;
         char infoLog[512];
 
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
-
         // check for shader compile errors
-        glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+        glGetShaderiv(pendingVertex, GL_COMPILE_STATUS, &success);
         if (!success) {
-            glGetShaderInfoLog(vertex, 512, NULL, infoLog);
+            glGetShaderInfoLog(pendingVertex, 512, NULL, infoLog);
             std::cout << "ERROR::SHADER::VERTEX::COMPILATION::FAILED\n"
                       << infoLog << std::endl;
         }
-
-        // fragment shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
-
-        //check for errors
-        glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+        glGetShaderiv(pendingFragment, GL_COMPILE_STATUS, &success);
         if (!success) {
-            glGetShaderInfoLog(fragment, 512, NULL, infoLog);
+            glGetShaderInfoLog(pendingFragment, 512, NULL, infoLog);
             std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION::FAILED\n"
                       << infoLog << std::endl;
         }
 
-        ID = glCreateProgram();
-        glAttachShader(ID, vertex);
-        glAttachShader(ID, fragment);
-        glLinkProgram(ID);
-        // Check for errors
         glGetProgramiv(ID, GL_LINK_STATUS, &success);
         if (!success) {
             glGetProgramInfoLog(ID, 512, NULL, infoLog);
             std::cout << "ERROR::SHADER::PROGRAM::LINKING::FAILED\n"
                       << infoLog << std::endl;
         }
+        linked = success != 0;
         // Delete shaders
-        glDeleteShader(vertex);
-        glDeleteShader(fragment);
-    }
+        glDetachShader(ID, pendingVertex);
+        glDetachShader(ID, pendingFragment);
+        glDeleteShader(pendingVertex);
+        glDeleteShader(pendingFragment);
+        pendingVertex = pendingFragment = 0;
 
-    // activate shader
-    void use() {
-        glUseProgram(ID);
+        if (linked)
+            ShaderCache::store(ID, cacheKey);
+        reflectUniforms();
     }
 
-    // functions for uniforms
-    void setBool(const std::string &name, bool value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
-    }
-    void set1i(const std::string &name, int value) const {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
-    }
-    void set1f(const std::string &name, float value) const {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    // the defines have to follow #version, which must stay the first statement
+    static std::string injectDefines(const std::string &code, const std::string &defines) {
+        if (defines.empty())
+            return code;
+        size_t version = code.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : code.find('\n', version);
+        if (lineEnd == std::string::npos)
+            return defines + "\n" + code;
+        return code.substr(0, lineEnd + 1) + defines + "\n" + code.substr(lineEnd + 1);
     }
-    void set3f(const std::string &name, glm::vec3 values) const {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), values.x, values.y, values.z);
+
+    struct Uniform {
+        int location;
+        std::string name;
+    };
+    std::unordered_map<uint64_t, Uniform> uniforms;  // hashString(name) -> location
+    std::vector<UniformLocation> declaredLocations;  // fills in names the driver didn't report
+    mutable std::vector<int> samplerUnits;           // location -> unit set through setSampler, -1 unknown
+
+    static uint64_t nextSerial() {
+        static uint64_t serial = 0;
+        return ++serial;
     }
-    void set3f(const std::string &name, float x, float y, float z) const {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+
+    void addUniform(const std::string &name, int location) {
+        auto inserted = uniforms.emplace(hashString(name), Uniform{location, name});
+        if (!inserted.second && inserted.first->second.name != name)
+            std::cout << "WARNING::SHADER::UNIFORM_HASH_COLLISION " << name << " / " << inserted.first->second.name << std::endl;
     }
-    void setmatrix4(const std::string &name, glm::mat4 values) const {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(values));
+
+    // queries every active uniform once so the setters never have to ask GL for a location
+    void reflectUniforms() {
+        int count = 0, maxLength = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> buffer(maxLength + 1);
+        for (int i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type;
+            glGetActiveUniform(ID, i, (GLsizei)buffer.size(), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            int location = glGetUniformLocation(ID, name.c_str());
+            // members of uniform blocks have no location
+            if (location < 0)
+                continue;
+
+            // arrays are reported as "name[0]", register "name" and every element
+            size_t bracket = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0 ? name.size() - 3 : std::string::npos;
+            if (bracket == std::string::npos) {
+                addUniform(name, location);
+                continue;
+            }
+            std::string base = name.substr(0, bracket);
+            addUniform(base, location);
+            for (int element = 0; element < size; element++) {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                addUniform(elementName, glGetUniformLocation(ID, elementName.c_str()));
+            }
+        }
+        for (const UniformLocation &declared : declaredLocations) {
+            if (linked && uniforms.find(hashString(declared.name)) == uniforms.end())
+                addUniform(declared.name, declared.location);
+        }
     }
 };
 
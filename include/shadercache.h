@@ -0,0 +1,136 @@
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <glad/glad.h>
+#include <hash.h>
+#include <mappedfile.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// On-disk cache of linked program binaries (glGetProgramBinary), one file per program in shadercache/.
+// The key covers the final sources (defines included) and the driver strings, a driver update simply misses.
+// Layout: ShaderCacheHeader followed by the binary
+const uint32_t SHADER_CACHE_MAGIC = 0x43524853;  // "SHRC"
+const uint32_t SHADER_CACHE_VERSION = 1;
+
+struct ShaderCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t binaryFormat;
+    uint32_t binarySize;
+    uint64_t key;
+};
+
+class ShaderCache {
+   public:
+    // set to false to always compile from source
+    static bool &enabled() {
+        static bool value = true;
+        return value;
+    }
+
+    static std::string directory() {
+        return "shadercache";
+    }
+
+    // key over the program sources and the driver that compiled them
+    static uint64_t programKey(const std::string &vertexCode, const std::string &fragmentCode) {
+        return programKey(hashCombine(hashString(vertexCode), hashString(fragmentCode)));
+    }
+    // same for sources that are already hashed, e.g. SPIR-V modules and their specialization
+    static uint64_t programKey(uint64_t sourceHash) {
+        uint64_t key = hashCombine(sourceHash, hashString(glString(GL_VENDOR)));
+        key = hashCombine(key, hashString(glString(GL_RENDERER)));
+        key = hashCombine(key, hashString(glString(GL_VERSION)));
+        return hashCombine(key, SHADER_CACHE_VERSION);
+    }
+
+    static std::string pathFor(uint64_t key) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+        return directory() + "/" + name;
+    }
+
+    // loads the cached binary into program, false if there is none or the driver rejects it (the stale file is removed)
+    static bool load(unsigned int program, uint64_t key) {
+        if (!enabled() || !supported())
+            return false;
+        std::string path = pathFor(key);
+        MappedFile file(path);
+        if (!file.isOpen())
+            return false;
+
+        ShaderCacheHeader header;
+        if (file.size() < sizeof(header))
+            return reject(file, path);
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION || header.key != key ||
+            file.size() - sizeof(header) < header.binarySize)
+            return reject(file, path);
+
+        glProgramBinary(program, header.binaryFormat, file.data() + sizeof(header), header.binarySize);
+        int success = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success)
+            return reject(file, path);
+        return true;
+    }
+
+    // writes the binary of a linked program, the program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    static bool store(unsigned int program, uint64_t key) {
+        if (!enabled() || !supported())
+            return false;
+        int length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return false;
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        std::error_code error;
+        std::filesystem::create_directories(directory(), error);
+        std::string path = pathFor(key);
+        std::string tempPath = path + ".tmp";
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        ShaderCacheHeader header = {SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, (uint32_t)format, (uint32_t)length, key};
+        out.write((const char *)&header, sizeof(header));
+        out.write(binary.data(), length);
+        out.close();
+        if (!out) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        std::remove(path.c_str());
+        return std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+
+    // some drivers expose no binary formats at all
+    static bool supported() {
+        int formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+   private:
+    static std::string glString(GLenum name) {
+        const GLubyte *value = glGetString(name);
+        return value ? (const char *)value : "";
+    }
+
+    static bool reject(MappedFile &file, const std::string &path) {
+        file.close();
+        std::remove(path.c_str());
+        return false;
+    }
+};
+
+#endif
@@ -0,0 +1,218 @@
+#ifndef SHADERLIBRARY_H
+#define SHADERLIBRARY_H
+
+#include <filewatcher.h>
+#include <shader.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// A program that can be rebuilt while it's drawn with: the last finished build stays current until its
+// replacement is done, and a replacement that fails to link is dropped so a broken edit keeps the old program.
+// The swap happens in poll() on the GL thread between draws, so get() once per frame instead of keeping the pointer.
+class ShaderProgram {
+   public:
+    // GLSL sources, or the SPIR-V modules when spirv is set
+    const std::string vertexPath, fragmentPath, defines;
+    const bool spirv;
+
+    ShaderProgram(const std::string &vertexPath, const std::string &fragmentPath, const std::string &defines)
+        : vertexPath(vertexPath), fragmentPath(fragmentPath), defines(defines), spirv(false) {}
+    ShaderProgram(const SpirvModule &vertex, const SpirvModule &fragment, const std::vector<UniformLocation> &uniformLocations)
+        : vertexPath(vertex.path), fragmentPath(fragment.path), spirv(true), vertexConstants(vertex.constants), fragmentConstants(fragment.constants),
+          uniformLocations(uniformLocations) {}
+
+    // the programs are deleted with this, so the context has to outlive it
+    ~ShaderProgram() {
+        if (current)
+            current->release();
+        if (pending)
+            pending->release();
+    }
+
+    ShaderProgram(const ShaderProgram &) = delete;
+    ShaderProgram &operator=(const ShaderProgram &) = delete;
+
+    // the current program, NULL until the first build is done
+    Shader *get() {
+        return current.get();
+    }
+
+    bool building() const {
+        return pending != nullptr;
+    }
+
+    // starts a new build from the files, a build that was still running is thrown away
+    void rebuild(ShaderBuild mode) {
+        if (pending)
+            pending->release();
+        if (spirv)
+            pending = std::make_unique<Shader>(SpirvModule{vertexPath, vertexConstants}, SpirvModule{fragmentPath, fragmentConstants}, uniformLocations, mode);
+        else
+            pending = std::make_unique<Shader>(vertexPath.c_str(), fragmentPath.c_str(), defines, mode);
+    }
+
+    // swaps in the pending build once it's done, true when the current program changed
+    bool poll() {
+        if (!pending || !pending->ready())
+            return false;
+        // the first build becomes current even when it failed, just like a plain Shader
+        if (pending->linked || !current) {
+            if (current)
+                current->release();
+            current = std::move(pending);
+            return true;
+        }
+        std::cout << "WARNING::SHADER_LIBRARY::REBUILD_FAILED " << vertexPath << " " << fragmentPath
+                  << ", keeping the previous program" << std::endl;
+        pending->release();
+        pending.reset();
+        return false;
+    }
+
+    // whether the program is built from path
+    bool uses(const std::string &path) const {
+        std::filesystem::path normalized = std::filesystem::path(path).lexically_normal();
+        return std::filesystem::path(vertexPath).lexically_normal() == normalized ||
+               std::filesystem::path(fragmentPath).lexically_normal() == normalized;
+    }
+
+   private:
+    std::vector<SpecializationConstant> vertexConstants, fragmentConstants;
+    std::vector<UniformLocation> uniformLocations;
+    std::unique_ptr<Shader> current, pending;
+};
+
+// Owns every program of the application and builds them without stalling the frame: in SHADER_BUILD_ASYNC mode
+// load() hands out a ShaderProgram right away and update() swaps the builds in as the driver finishes them.
+// With GL_KHR_parallel_shader_compile a build runs per hardware thread on the driver's threads, without it update()
+// starts one build per call and checks it on the next, so at most one compile lands in any frame.
+// watch() adds hot reload: programs built from a file that changes in the directory are rebuilt the same way.
+class ShaderLibrary {
+   public:
+    explicit ShaderLibrary(ShaderBuild mode = SHADER_BUILD_ASYNC) : mode(mode) {}
+
+    ShaderLibrary(const ShaderLibrary &) = delete;
+    ShaderLibrary &operator=(const ShaderLibrary &) = delete;
+
+    // the program for these sources, created on first use. in SHADER_BUILD_NOW mode it is built before this returns
+    ShaderProgram &load(const std::string &vertexPath, const std::string &fragmentPath, const std::string &defines = "") {
+        std::string key = vertexPath + '\n' + fragmentPath + '\n' + defines;
+        auto it = programs.find(key);
+        if (it != programs.end())
+            return *it->second;
+        return add(key, std::make_unique<ShaderProgram>(vertexPath, fragmentPath, defines));
+    }
+
+    // the same for SPIR-V modules, see Shader(const SpirvModule &, ...)
+    ShaderProgram &load(const SpirvModule &vertex, const SpirvModule &fragment, const std::vector<UniformLocation> &uniformLocations = {}) {
+        std::string key = vertex.path + '\n' + fragment.path + '\n';
+        for (const SpirvModule *module : {&vertex, &fragment}) {
+            for (const SpecializationConstant &constant : module->constants)
+                key += std::to_string(constant.id) + '=' + std::to_string(constant.value) + ' ';
+            key += '\n';
+        }
+        auto it = programs.find(key);
+        if (it != programs.end())
+            return *it->second;
+        return add(key, std::make_unique<ShaderProgram>(vertex, fragment, uniformLocations));
+    }
+
+    // rebuild the programs whose files change in directory (not its subdirectories)
+    void watch(const std::string &directory) {
+        watchers.push_back(std::make_unique<FileWatcher>(directory));
+    }
+
+    // call once per frame on the GL thread: swaps in finished builds, then starts the next ones.
+    // returns the number of programs that changed
+    unsigned int update() {
+        for (auto &watcher : watchers) {
+            for (const std::string &file : watcher->changedFiles()) {
+                // the embedded copy is out of date now
+                Shader::overrideFromDisk(file);
+                for (auto &program : programs) {
+                    if (program.second->uses(file))
+                        queue(program.second.get());
+                }
+            }
+        }
+
+        // synchronous rebuilds finish right away and can be swapped in below
+        if (mode == SHADER_BUILD_NOW)
+            startQueued();
+        unsigned int swapped = 0;
+        for (auto &program : programs) {
+            if (program.second->poll())
+                swapped++;
+        }
+        startQueued();
+        return swapped;
+    }
+
+    // programs waiting for their build to start or finish
+    size_t building() const {
+        size_t count = queued.size();
+        for (auto &program : programs)
+            count += program.second->building() ? 1 : 0;
+        return count;
+    }
+
+    // blocks until every queued and running build has been swapped in
+    void finish() {
+        while (building() > 0)
+            update();
+    }
+
+    size_t size() const {
+        return programs.size();
+    }
+
+   private:
+    ShaderBuild mode;
+    std::unordered_map<std::string, std::unique_ptr<ShaderProgram>> programs;  // vertex, fragment and defines -> program
+    std::vector<ShaderProgram *> queued;                                       // waiting for their build to start
+    std::vector<std::unique_ptr<FileWatcher>> watchers;
+
+    ShaderProgram &add(const std::string &key, std::unique_ptr<ShaderProgram> program) {
+        ShaderProgram &added = *programs.emplace(key, std::move(program)).first->second;
+        queue(&added);
+        startQueued();
+        if (mode == SHADER_BUILD_NOW)
+            added.poll();
+        return added;
+    }
+
+    void queue(ShaderProgram *program) {
+        if (std::find(queued.begin(), queued.end(), program) == queued.end())
+            queued.push_back(program);
+    }
+
+    // starts queued builds while fewer than maxInFlight() are running
+    void startQueued() {
+        size_t running = 0;
+        for (auto &program : programs)
+            running += program.second->building() ? 1 : 0;
+        while (!queued.empty() && (mode == SHADER_BUILD_NOW || running < maxInFlight())) {
+            ShaderProgram *program = queued.front();
+            queued.erase(queued.begin());
+            program->rebuild(mode);
+            running++;
+        }
+    }
+
+    // the driver parses the sources in glCompileShader on the calling thread even when it compiles in parallel,
+    // so starting everything at once would land in one frame. without parallel compile it may compile right there
+    static size_t maxInFlight() {
+        if (!Shader::parallelCompileSupported())
+            return 1;
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+};
+
+#endif
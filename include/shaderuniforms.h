@@ -0,0 +1,121 @@
+// generated by tools/shaderembed from shaders/, don't edit
+#ifndef SHADERUNIFORMS_H
+#define SHADERUNIFORMS_H
+
+#include <shader.h>
+
+// default block uniforms of every shader file, struct members flattened
+namespace shaderuniforms {
+
+namespace shader_1_model_loading_fs {
+constexpr UniformName TEXTURE_DIFFUSE1("texture_diffuse1");
+}  // namespace shader_1_model_loading_fs
+
+namespace shader_1_model_loading_vs {
+constexpr UniformName MODEL("model");
+constexpr UniformName VIEW("view");
+constexpr UniformName PROJECTION("projection");
+}  // namespace shader_1_model_loading_vs
+
+namespace shader_4_6_shader_fs {
+constexpr UniformName TEXTURE1("texture1");
+constexpr UniformName TEXTURE2("texture2");
+}  // namespace shader_4_6_shader_fs
+
+namespace shader_4_6_shader_vs {
+constexpr UniformName MODEL("model");
+constexpr UniformName VIEW("view");
+constexpr UniformName PROJECTION("projection");
+}  // namespace shader_4_6_shader_vs
+
+namespace directionlight_fs {
+constexpr UniformName MATERIAL_DIFFUSE("material.diffuse");
+constexpr UniformName MATERIAL_SPECULAR("material.specular");
+constexpr UniformName MATERIAL_SHININESS("material.shininess");
+constexpr UniformName LIGHT_DIRECTION("light.direction");
+constexpr UniformName LIGHT_AMBIENT("light.ambient");
+constexpr UniformName LIGHT_DIFFUSE("light.diffuse");
+constexpr UniformName LIGHT_SPECULAR("light.specular");
+}  // namespace directionlight_fs
+
+namespace directionlight_vs {
+constexpr UniformName MODEL("model");
+constexpr UniformName VIEW("view");
+constexpr UniformName PROJECTION("projection");
+}  // namespace directionlight_vs
+
+namespace fbo_fs {
+constexpr UniformName SCREEN_TEXTURE("screenTexture");
+constexpr UniformName LAYER("layer");
+constexpr UniformName RENDER_SCALE("renderScale");
+}  // namespace fbo_fs
+
+namespace fbo_vs {
+}  // namespace fbo_vs
+
+namespace flashlight_fs {
+constexpr UniformName MATERIAL_DIFFUSE("material.diffuse");
+constexpr UniformName MATERIAL_SPECULAR("material.specular");
+constexpr UniformName MATERIAL_SHININESS("material.shininess");
+constexpr UniformName LIGHT_DIRECTION("light.direction");
+constexpr UniformName LIGHT_CUT_OFF("light.cutOff");
+constexpr UniformName LIGHT_OUTER_CUT_OFF("light.outerCutOff");
+constexpr UniformName LIGHT_AMBIENT("light.ambient");
+constexpr UniformName LIGHT_DIFFUSE("light.diffuse");
+constexpr UniformName LIGHT_SPECULAR("light.specular");
+constexpr UniformName LIGHT_CONSTANT("light.constant");
+constexpr UniformName LIGHT_LINEAR("light.linear");
+constexpr UniformName LIGHT_QUADRATIC("light.quadratic");
+}  // namespace flashlight_fs
+
+namespace lightcube_fs {
+}  // namespace lightcube_fs
+
+namespace lightingshader_fs {
+constexpr UniformName MATERIAL_DIFFUSE("material.diffuse");
+constexpr UniformName MATERIAL_SPECULAR("material.specular");
+constexpr UniformName MATERIAL_SHININESS("material.shininess");
+constexpr UniformName LIGHT_AMBIENT("light.ambient");
+constexpr UniformName LIGHT_DIFFUSE("light.diffuse");
+constexpr UniformName LIGHT_SPECULAR("light.specular");
+constexpr UniformName LIGHT_CONSTANT("light.constant");
+constexpr UniformName LIGHT_LINEAR("light.linear");
+constexpr UniformName LIGHT_QUADRATIC("light.quadratic");
+}  // namespace lightingshader_fs
+
+namespace lightingshader_vs {
+constexpr UniformName MODEL("model");
+constexpr UniformName VIEW("view");
+constexpr UniformName PROJECTION("projection");
+constexpr UniformName LIGHT_POS("lightPos");
+constexpr UniformName LIGHTDIR("lightdir");
+}  // namespace lightingshader_vs
+
+namespace multilight_fs {
+constexpr UniformName MATERIAL_TEXTURE_DIFFUSE1("material.texture_diffuse1");
+constexpr UniformName MATERIAL_TEXTURE_SPECULAR1("material.texture_specular1");
+constexpr UniformName MATERIAL_TEXTURE_NORMAL1("material.texture_normal1");
+}  // namespace multilight_fs
+
+namespace multilight_vs {
+constexpr UniformName MODEL("model");
+}  // namespace multilight_vs
+
+namespace multilight_packed_vs {
+constexpr UniformName MODEL("model");
+constexpr UniformName POSITION_SCALE("positionScale");
+constexpr UniformName POSITION_OFFSET("positionOffset");
+}  // namespace multilight_packed_vs
+
+namespace singlecolor_fs {
+}  // namespace singlecolor_fs
+
+namespace singlecolor_vs {
+constexpr UniformName MODEL("model");
+constexpr UniformName VIEW("view");
+constexpr UniformName PROJECTION("projection");
+}  // namespace singlecolor_vs
+
+}  // namespace shaderuniforms
+
+#endif
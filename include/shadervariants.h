@@ -0,0 +1,125 @@
+#ifndef SHADERVARIANTS_H
+#define SHADERVARIANTS_H
+
+#include <shader.h>
+#include <shaderlibrary.h>
+#include <uniformbuffers.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// variant bits of the multilight shaders, each combination becomes its own program with the matching #defines
+const unsigned int SHADER_POINT_LIGHTS_MASK = 0x7;  // bits 0-2: number of point lights evaluated, 0 to MAX_POINT_LIGHTS
+const unsigned int SHADER_DIR_LIGHT = 1 << 3;
+const unsigned int SHADER_SPOT_LIGHT = 1 << 4;
+const unsigned int SHADER_ALPHA_TEST = 1 << 5;
+const unsigned int SHADER_NORMAL_MAP = 1 << 6;
+const unsigned int SHADER_INSTANCED = 1 << 7;   // transforms from InstanceBlock, see include/instancebuffer.h
+const unsigned int SHADER_MULTI_DRAW = 1 << 8;  // packed mesh bounds from MeshBlock, see include/meshbuffer.h
+const unsigned int SHADER_MULTI_VIEW = 1 << 9;  // every camera of MultiViewBlock in one pass, see include/layeredframebuffer.h
+
+// locations the multilight shaders declare for their default block uniforms, SPIR-V programs don't report the names
+const UniformLocation MULTILIGHT_UNIFORM_LOCATIONS[] = {
+    {"model", 0},
+    {"positionScale", 1},
+    {"positionOffset", 2},
+    {"material.texture_diffuse1", 3},
+    {"material.texture_specular1", 4},
+    {"material.texture_normal1", 5}};
+
+// GLSL variants get their values as #defines, SPIR-V variants as specialization constants of precompiled modules
+enum ShaderLanguage {
+    SHADER_GLSL,
+    SHADER_SPIRV
+};
+
+inline unsigned int shaderPointLights(int count) {
+    return (unsigned int)std::min(std::max(count, 0), MAX_POINT_LIGHTS);
+}
+
+// lazily compiled permutations of one vertex/fragment shader pair, keyed by their variant bits
+class ShaderVariants {
+   public:
+    // the variants are built by a private library, synchronously on first use
+    ShaderVariants(const std::string &vertexPath, const std::string &fragmentPath, ShaderLanguage language = SHADER_GLSL)
+        : ownLibrary(std::make_unique<ShaderLibrary>(SHADER_BUILD_NOW)), library(*ownLibrary), vertexPath(vertexPath), fragmentPath(fragmentPath), language(language) {}
+    // the variants are built and hot reloaded by library, in its mode. the library has to outlive the variants
+    ShaderVariants(ShaderLibrary &library, const std::string &vertexPath, const std::string &fragmentPath, ShaderLanguage language = SHADER_GLSL)
+        : library(library), vertexPath(vertexPath), fragmentPath(fragmentPath), language(language) {}
+
+    ShaderVariants(const ShaderVariants &) = delete;
+    ShaderVariants &operator=(const ShaderVariants &) = delete;
+
+    // current program of the variant, built (or loaded from the program binary cache) the first time it's asked for.
+    // NULL while an asynchronous first build is still running
+    Shader *get(unsigned int variant) {
+        auto it = variants.find(variant);
+        if (it == variants.end())
+            it = variants.emplace(variant, &load(variant)).first;
+        return it->second->get();
+    }
+
+    // number of variants asked for so far
+    size_t size() const {
+        return variants.size();
+    }
+
+    // whether tools/spirvcompile has built the modules SHADER_SPIRV needs for these sources
+    static bool spirvAvailable(const std::string &vertexPath, const std::string &fragmentPath) {
+        for (const std::string &path : {vertexPath, fragmentPath}) {
+            if (!std::filesystem::exists(Shader::spirvPathFor(path)) || !std::filesystem::exists(Shader::spirvPathFor(path, "normalmap")))
+                return false;
+        }
+        return true;
+    }
+
+    static std::string definesFor(unsigned int variant) {
+        std::string defines;
+        defines += "#define POINT_LIGHT_COUNT " + std::to_string(std::min(variant & SHADER_POINT_LIGHTS_MASK, (unsigned int)MAX_POINT_LIGHTS)) + "\n";
+        defines += std::string("#define DIR_LIGHT ") + (variant & SHADER_DIR_LIGHT ? "1" : "0") + "\n";
+        defines += std::string("#define SPOT_LIGHT ") + (variant & SHADER_SPOT_LIGHT ? "1" : "0") + "\n";
+        defines += std::string("#define ALPHA_TEST ") + (variant & SHADER_ALPHA_TEST ? "1" : "0") + "\n";
+        defines += std::string("#define NORMAL_MAP ") + (variant & SHADER_NORMAL_MAP ? "1" : "0") + "\n";
+        defines += std::string("#define INSTANCED ") + (variant & SHADER_INSTANCED ? "1" : "0") + "\n";
+        defines += std::string("#define MULTI_DRAW ") + (variant & SHADER_MULTI_DRAW ? "1" : "0") + "\n";
+        defines += std::string("#define MULTI_VIEW ") + (variant & SHADER_MULTI_VIEW ? "1" : "0") + "\n";
+        return defines;
+    }
+
+    // the specialization constants of the multilight vertex shaders
+    static std::vector<SpecializationConstant> vertexConstantsFor(unsigned int variant) {
+        return {{4, variant & SHADER_INSTANCED ? 1u : 0u}, {5, variant & SHADER_MULTI_DRAW ? 1u : 0u}, {6, variant & SHADER_MULTI_VIEW ? 1u : 0u}};
+    }
+
+    // the same values as the specialization constants multilight.fs declares, all but NORMAL_MAP
+    static std::vector<SpecializationConstant> constantsFor(unsigned int variant) {
+        return {{0, std::min(variant & SHADER_POINT_LIGHTS_MASK, (unsigned int)MAX_POINT_LIGHTS)},
+                {1, variant & SHADER_DIR_LIGHT ? 1u : 0u},
+                {2, variant & SHADER_SPOT_LIGHT ? 1u : 0u},
+                {3, variant & SHADER_ALPHA_TEST ? 1u : 0u}};
+    }
+
+   private:
+    std::unique_ptr<ShaderLibrary> ownLibrary;
+    ShaderLibrary &library;
+    std::string vertexPath, fragmentPath;
+    ShaderLanguage language;
+    std::unordered_map<unsigned int, ShaderProgram *> variants;  // owned by the library
+
+    ShaderProgram &load(unsigned int variant) {
+        if (language == SHADER_GLSL)
+            return library.load(vertexPath, fragmentPath, definesFor(variant));
+        // NORMAL_MAP changes the stage interface and has modules of its own
+        std::string modules = variant & SHADER_NORMAL_MAP ? "normalmap" : "";
+        return library.load(SpirvModule{Shader::spirvPathFor(vertexPath, modules), vertexConstantsFor(variant)},
+                            SpirvModule{Shader::spirvPathFor(fragmentPath, modules), constantsFor(variant)},
+                            std::vector<UniformLocation>(std::begin(MULTILIGHT_UNIFORM_LOCATIONS), std::end(MULTILIGHT_UNIFORM_LOCATIONS)));
+    }
+};
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <glad/glad.h>
+#include <glstate.h>
+#include <hash.h>
+#include <mappedfile.h>
+#include <textureloader.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma);
+
+// how textures are identified in the cache
+enum TextureKeyMode {
+    TEXTURE_KEY_PATH,    // hash of the normalized file path, cheap
+    TEXTURE_KEY_CONTENT  // hash of the file contents, also shares identical files stored under different names
+};
+
+struct TextureCacheStats {
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    size_t bytesUploaded = 0;  // estimated VRAM of all textures that were decoded and uploaded
+    size_t bytesShared = 0;    // estimated VRAM that would have been spent on duplicates
+};
+
+// Process wide registry of loaded textures. Every acquire returns a reference counted GL texture,
+// the texture is deleted once the last reference has been released. Only used from the GL thread.
+class TextureCache {
+   public:
+    TextureKeyMode keyMode = TEXTURE_KEY_PATH;
+
+    static TextureCache &shared() {
+        static TextureCache cache;
+        return cache;
+    }
+
+    // routes all further loads through the given background loader (nullptr loads synchronously again).
+    // the cache keeps a pointer to it, see AsyncTextureLoaderScope for unsetting it before the loader goes away
+    void setAsyncLoader(AsyncTextureLoader *asyncLoader) {
+        if (loader)
+            loader->onUploaded = nullptr;
+        loader = asyncLoader;
+        if (loader)
+            loader->onUploaded = [this](unsigned int id, size_t bytes) { uploaded(id, bytes); };
+    }
+
+    // returns the texture for directory/path, loading it the first time it's requested
+    unsigned int acquire(const std::string &path, const std::string &directory, bool gamma = false) {
+        std::string fullPath = normalize(directory + '/' + path);
+        uint64_t key = makeKey(fullPath, gamma);
+
+        auto found = entries.find(key);
+        if (found != entries.end()) {
+            found->second.refs++;
+            found->second.hits++;
+            counters.hits++;
+            counters.bytesShared += found->second.bytes;
+            return found->second.id;
+        }
+
+        Entry entry;
+        entry.refs = 1;
+        entry.hits = 0;
+        entry.bytes = 0;
+        counters.misses++;
+        if (loader) {
+            // the size is only known once the loader has decoded the image, see uploaded()
+            entry.id = loader->request(path, directory);
+        } else {
+            entry.id = TextureFromFile(path.c_str(), directory, gamma);
+            entry.bytes = textureBytes(entry.id);
+            counters.bytesUploaded += entry.bytes;
+        }
+        entries[key] = entry;
+        keysById[entry.id] = key;
+        return entry.id;
+    }
+
+    // drops one reference, deleting the GL texture with the last one
+    void release(unsigned int id) {
+        auto key = keysById.find(id);
+        if (key == keysById.end())
+            return;
+        auto entry = entries.find(key->second);
+        if (--entry->second.refs == 0) {
+            if (loader)
+                loader->cancel(id);
+            GLState::shared().forgetTexture(entry->second.id);
+            glDeleteTextures(1, &entry->second.id);
+            entries.erase(entry);
+            keysById.erase(key);
+        }
+    }
+
+    unsigned int refCount(unsigned int id) const {
+        auto key = keysById.find(id);
+        return key == keysById.end() ? 0 : entries.at(key->second).refs;
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    const TextureCacheStats &stats() const {
+        return counters;
+    }
+
+    void printStats() const {
+        std::cout << "textures: " << entries.size() << " loaded, " << counters.hits << " hits, " << counters.misses << " misses, "
+                  << counters.bytesUploaded / (1024.0 * 1024.0) << " MB uploaded, " << counters.bytesShared / (1024.0 * 1024.0) << " MB saved by sharing" << std::endl;
+    }
+
+   private:
+    struct Entry {
+        unsigned int id;
+        unsigned int refs;
+        unsigned int hits;
+        size_t bytes;
+    };
+
+    std::unordered_map<uint64_t, Entry> entries;
+    std::unordered_map<unsigned int, uint64_t> keysById;
+    TextureCacheStats counters;
+    AsyncTextureLoader *loader = nullptr;
+
+    TextureCache() {}
+
+    // late size accounting for textures streamed in by the async loader
+    void uploaded(unsigned int id, size_t bytes) {
+        auto key = keysById.find(id);
+        if (key == keysById.end())
+            return;
+        Entry &entry = entries[key->second];
+        entry.bytes = bytes;
+        counters.bytesUploaded += bytes;
+        counters.bytesShared += bytes * entry.hits;
+    }
+
+    static std::string normalize(const std::string &path) {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    uint64_t makeKey(const std::string &fullPath, bool gamma) const {
+        uint64_t key = 0;
+        if (keyMode == TEXTURE_KEY_CONTENT) {
+            MappedFile file(fullPath);
+            if (file.isOpen())
+                key = hashBytes(file.data(), file.size());
+        }
+        // unreadable files still get a path key so the failure is only reported once
+        if (key == 0)
+            key = hashString(fullPath);
+        return hashCombine(key, gamma ? 1 : 0);
+    }
+
+    // estimates the memory of a texture from its base level, including a full mip chain
+    static size_t textureBytes(unsigned int id) {
+        GLint width = 0, height = 0, compressed = 0, red = 0, green = 0, blue = 0, alpha = 0;
+        GLState::shared().bindTexture(id);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED, &compressed);
+        size_t baseBytes;
+        if (compressed) {
+            GLint imageSize = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &imageSize);
+            baseBytes = (size_t)imageSize;
+        } else {
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_RED_SIZE, &red);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_GREEN_SIZE, &green);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_BLUE_SIZE, &blue);
+            glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_ALPHA_SIZE, &alpha);
+            baseBytes = (size_t)width * height * (red + green + blue + alpha) / 8;
+        }
+        return baseBytes * 4 / 3;
+    }
+};
+
+// routes TextureCache::shared() through a loader for as long as it lives and back to synchronous loads when it's
+// destroyed, so the cache never keeps a loader that's gone. declare it after the loader
+class AsyncTextureLoaderScope {
+   public:
+    explicit AsyncTextureLoaderScope(AsyncTextureLoader &loader) {
+        TextureCache::shared().setAsyncLoader(&loader);
+    }
+
+    ~AsyncTextureLoaderScope() {
+        TextureCache::shared().setAsyncLoader(nullptr);
+    }
+
+    AsyncTextureLoaderScope(const AsyncTextureLoaderScope &) = delete;
+    AsyncTextureLoaderScope &operator=(const AsyncTextureLoaderScope &) = delete;
+};
+
+#endif
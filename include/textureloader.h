@@ -0,0 +1,239 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include <glad/glad.h>
+#include <glstate.h>
+#include <ktx2.h>
+#include <stb_image.h>
+#include <threadpool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Loads textures in the background: worker threads decode the images while update() streams the
+// decoded pixels to the GL textures through a ring of pixel buffer objects on the context thread.
+// request() returns immediately with a texture that shows a 1x1 placeholder until its data arrives.
+class AsyncTextureLoader {
+   public:
+    // called on the GL thread once a texture holds its real data, with its estimated size in bytes
+    std::function<void(unsigned int id, size_t bytes)> onUploaded;
+
+    // hardware_concurrency() may be 0, clamp it before leaving a core to the GL thread
+    explicit AsyncTextureLoader(unsigned int decodeThreads = std::max(1u, std::max(1u, std::thread::hardware_concurrency()) - 1)) : workers(decodeThreads) {
+        glGenBuffers(PBO_COUNT, pbos);
+    }
+
+    ~AsyncTextureLoader() {
+        // wait for the workers before freeing what they produced
+        waitForDecodes();
+        for (Decoded &image : ready)
+            stbi_image_free(image.pixels);
+        glDeleteBuffers(PBO_COUNT, pbos);
+    }
+
+    AsyncTextureLoader(const AsyncTextureLoader &) = delete;
+    AsyncTextureLoader &operator=(const AsyncTextureLoader &) = delete;
+
+    // creates the texture with placeholder contents and queues directory/path for decoding
+    unsigned int request(const std::string &path, const std::string &directory) {
+        unsigned int textureID;
+        glGenTextures(1, &textureID);
+        GLState::shared().bindTexture(textureID);
+        const unsigned char placeholder[4] = {128, 128, 128, 255};
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        std::string filename = directory + '/' + path;
+        unsigned int generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            generation = ++nextGeneration;
+            inFlight[textureID] = generation;
+            decoding++;
+        }
+        workers.submit([this, textureID, generation, filename]() {
+            Decoded image;
+            image.id = textureID;
+            image.generation = generation;
+            image.filename = filename;
+            // a pre-compressed KTX2 file only needs reading, the blocks go to the GPU untouched
+            std::ifstream compressed(ktx2PathFor(filename), std::ios::binary);
+            if (compressed)
+                image.compressed.assign(std::istreambuf_iterator<char>(compressed), std::istreambuf_iterator<char>());
+            // one that doesn't parse is skipped for the image itself, like TextureFromFile does
+            Ktx2Image ktx;
+            if (!image.compressed.empty() && !parseKtx2(image.compressed.data(), image.compressed.size(), ktx))
+                image.compressed.clear();
+            if (image.compressed.empty())
+                image.pixels = stbi_load(filename.c_str(), &image.width, &image.height, &image.components, 0);
+            std::lock_guard<std::mutex> lock(mutex);
+            ready.push_back(std::move(image));
+            decoding--;
+            decoded.notify_all();
+        });
+        return textureID;
+    }
+
+    // forget a texture that is about to be deleted. its decode may still finish, but once GL reuses the name the
+    // new request has another generation, so the stale pixels are dropped instead of uploaded
+    void cancel(unsigned int id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight.erase(id);
+    }
+
+    // uploads decoded images, call once per frame on the GL thread. byteBudget limits how much gets
+    // streamed in one call (0 = everything that's ready), returns the number of textures finished.
+    unsigned int update(size_t byteBudget = 0) {
+        unsigned int finished = 0;
+        size_t streamed = 0;
+        while (byteBudget == 0 || streamed < byteBudget) {
+            Decoded image;
+            bool wanted;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (ready.empty())
+                    break;
+                image = std::move(ready.front());
+                ready.pop_front();
+                auto request = inFlight.find(image.id);
+                wanted = request != inFlight.end() && request->second == image.generation;
+                if (wanted)
+                    inFlight.erase(request);
+            }
+            if (wanted) {
+                streamed += upload(image);
+                finished++;
+            }
+            stbi_image_free(image.pixels);
+        }
+        return finished;
+    }
+
+    // textures still being decoded or waiting for their upload
+    size_t pending() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return inFlight.size();
+    }
+
+    // blocks until every requested texture has been uploaded
+    void finish() {
+        while (pending() > 0) {
+            update();
+            std::unique_lock<std::mutex> lock(mutex);
+            decoded.wait(lock, [this]() { return !ready.empty() || inFlight.empty() || decoding == 0; });
+        }
+    }
+
+   private:
+    static const int PBO_COUNT = 4;
+
+    struct Decoded {
+        unsigned int id = 0;
+        unsigned int generation = 0;  // which request of id it belongs to
+        std::string filename;
+        unsigned char *pixels = nullptr;
+        int width = 0, height = 0, components = 0;
+        std::vector<uint8_t> compressed;  // contents of a KTX2 file, used instead of pixels
+    };
+
+    ThreadPool workers;
+    std::mutex mutex;
+    std::condition_variable decoded;
+    std::deque<Decoded> ready;
+    std::unordered_map<unsigned int, unsigned int> inFlight;  // texture -> generation of its current request
+    unsigned int nextGeneration = 0;
+    unsigned int decoding = 0;
+    unsigned int pbos[PBO_COUNT];
+    unsigned int nextPbo = 0;
+
+    void waitForDecodes() {
+        std::unique_lock<std::mutex> lock(mutex);
+        decoded.wait(lock, [this]() { return decoding == 0; });
+    }
+
+    // copies the pixels into the next PBO of the ring and lets the driver pull them into the texture
+    size_t upload(const Decoded &image) {
+        if (!image.compressed.empty())
+            return uploadCompressed(image);
+        if (!image.pixels) {
+            std::cout << "Texture failed to load at path: " << image.filename << std::endl;
+            return 0;
+        }
+        GLenum format = GL_RGBA;
+        if (image.components == 1)
+            format = GL_RED;
+        else if (image.components == 2)
+            format = GL_RG;
+        else if (image.components == 3)
+            format = GL_RGB;
+        size_t size = (size_t)image.width * image.height * image.components;
+
+        // orphaning the buffer before mapping means we never wait on a transfer that is still in flight
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+        nextPbo = (nextPbo + 1) % PBO_COUNT;
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, NULL, GL_STREAM_DRAW);
+        void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            std::memcpy(mapped, image.pixels, size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        GLState::shared().bindTexture(image.id);
+        if (mapped) {
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, (void *)0);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        } else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
+        }
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        size_t bytes = size * 4 / 3;
+        if (onUploaded)
+            onUploaded(image.id, bytes);
+        return size;
+    }
+
+    // streams a whole KTX2 file through a PBO, the level offsets in the file become the upload offsets
+    size_t uploadCompressed(const Decoded &image) {
+        Ktx2Image ktx;
+        if (!parseKtx2(image.compressed.data(), image.compressed.size(), ktx)) {
+            std::cout << "Texture failed to load at path: " << ktx2PathFor(image.filename) << std::endl;
+            return 0;
+        }
+        size_t size = image.compressed.size();
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+        nextPbo = (nextPbo + 1) % PBO_COUNT;
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, size, image.compressed.data(), GL_STREAM_DRAW);
+        GLState::shared().bindTexture(image.id);
+        uploadKtx2(ktx, image.compressed.data());
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        size_t bytes = 0;
+        for (size_t levelSize : ktx.levelSizes)
+            bytes += levelSize;
+        if (onUploaded)
+            onUploaded(image.id, bytes);
+        return size;
+    }
+};
+
+#endif
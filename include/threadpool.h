@@ -0,0 +1,119 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads pulling jobs from a shared queue
+class ThreadPool {
+   public:
+    explicit ThreadPool(unsigned int threadCount) {
+        for (unsigned int i = 0; i < threadCount; i++)
+            workers.emplace_back([this]() { workerLoop(); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // process wide pool sized to the machine, leaving one core for the thread that owns the GL context
+    static ThreadPool &shared() {
+        static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+        return pool;
+    }
+
+    unsigned int size() const {
+        return (unsigned int)workers.size();
+    }
+
+    void submit(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+   private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    void workerLoop() {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+};
+
+// calls func(i) for every i in [0, count) on the shared pool and returns once all calls finished.
+// the calling thread works through the range too, so nesting inside a pool job can't deadlock.
+template <typename Func>
+void parallelFor(size_t count, Func &&func) {
+    if (count == 0)
+        return;
+    ThreadPool &pool = ThreadPool::shared();
+    size_t helpers = std::min((size_t)pool.size(), count - 1);
+    if (helpers == 0) {
+        for (size_t i = 0; i < count; i++)
+            func(i);
+        return;
+    }
+
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+    // jobs that start after the range is exhausted only touch the shared state, never func
+    auto run = [state, count, &func]() {
+        size_t processed = 0;
+        for (size_t i = state->next++; i < count; i = state->next++) {
+            func(i);
+            processed++;
+        }
+        if (processed > 0 && state->done.fetch_add(processed) + processed == count) {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->finished.notify_all();
+        }
+    };
+
+    for (size_t i = 0; i < helpers; i++)
+        pool.submit(run);
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, count]() { return state->done.load() == count; });
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef UNIFORMBUFFERS_H
+#define UNIFORMBUFFERS_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <vector>
+
+// C++ mirrors of the std140 uniform blocks declared in the multilight shaders.
+// under std140 a vec3 occupies 16 bytes unless a scalar follows it, the pad members keep the C++ offsets in step.
+
+// binding points, fixed in the shaders with layout (std140, binding = N)
+const unsigned int FRAME_BLOCK_BINDING = 0;
+const unsigned int VIEW_BLOCK_BINDING = 1;
+const unsigned int LIGHTING_BLOCK_BINDING = 2;
+const unsigned int MULTI_VIEW_BLOCK_BINDING = 3;
+
+// NR_POINT_LIGHTS in the shaders
+const int MAX_POINT_LIGHTS = 4;
+// MAX_MULTI_VIEWS in the vertex shaders, the most cameras one multi-view pass draws
+const int MAX_MULTI_VIEWS = 8;
+
+// FrameBlock, the same for every view
+struct FrameBlock {
+    float time;
+    float deltaTime;
+    glm::vec2 resolution;
+};
+static_assert(sizeof(FrameBlock) == 16, "FrameBlock must match the std140 layout");
+
+// ViewBlock, one per camera
+struct ViewBlock {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 viewPos;
+    float pad0;
+};
+static_assert(offsetof(ViewBlock, view) == 64 && offsetof(ViewBlock, viewPos) == 128, "ViewBlock must match the std140 layout");
+static_assert(sizeof(ViewBlock) == 144, "ViewBlock must match the std140 layout");
+
+// MultiViewBlock, the first viewCount cameras for the SHADER_MULTI_VIEW variants
+struct MultiViewBlock {
+    ViewBlock views[MAX_MULTI_VIEWS];
+    int viewCount;
+    int pad0[3];
+};
+static_assert(offsetof(MultiViewBlock, viewCount) == 1152 && sizeof(MultiViewBlock) == 1168, "MultiViewBlock must match the std140 layout");
+
+struct DirLightData {
+    glm::vec3 direction;
+    float pad0;
+    glm::vec3 ambient;
+    float pad1;
+    glm::vec3 diffuse;
+    float pad2;
+    glm::vec3 specular;
+    float pad3;
+};
+static_assert(offsetof(DirLightData, specular) == 48 && sizeof(DirLightData) == 64, "DirLight must match the std140 layout");
+
+struct PointLightData {
+    glm::vec3 position;
+    float pad0;
+    glm::vec3 ambient;
+    float pad1;
+    glm::vec3 diffuse;
+    float pad2;
+    glm::vec3 specular;
+    float constant;
+    float linear;
+    float quadratic;
+    float pad3[2];
+};
+static_assert(offsetof(PointLightData, constant) == 60 && offsetof(PointLightData, quadratic) == 68, "PointLight must match the std140 layout");
+static_assert(sizeof(PointLightData) == 80, "PointLight must match the std140 layout");
+
+struct SpotLightData {
+    glm::vec3 position;
+    float pad0;
+    glm::vec3 direction;
+    float cutOff;
+    float outerCutOff;
+    float pad1[3];
+    glm::vec3 ambient;
+    float pad2;
+    glm::vec3 diffuse;
+    float pad3;
+    glm::vec3 specular;
+    float constant;
+    float linear;
+    float quadratic;
+    float pad4[2];
+};
+static_assert(offsetof(SpotLightData, cutOff) == 28 && offsetof(SpotLightData, ambient) == 48, "SpotLight must match the std140 layout");
+static_assert(offsetof(SpotLightData, constant) == 92 && sizeof(SpotLightData) == 112, "SpotLight must match the std140 layout");
+
+// LightingBlock, shared by every view and every program that lights with it
+struct LightingBlock {
+    DirLightData dirLight;
+    PointLightData pointLights[MAX_POINT_LIGHTS];
+    SpotLightData spotLight;
+    float shininess;
+    float pad0[3];
+};
+static_assert(offsetof(LightingBlock, pointLights) == 64 && offsetof(LightingBlock, spotLight) == 384, "LightingBlock must match the std140 layout");
+static_assert(offsetof(LightingBlock, shininess) == 496 && sizeof(LightingBlock) == 512, "LightingBlock must match the std140 layout");
+
+// owns one uniform buffer holding the frame block, the lighting block, a view block per camera and the multi-view
+// block of all of them. fill in the members, upload() once per frame and bindView() before drawing each view.
+class SceneUniforms {
+   public:
+    FrameBlock frame = {};
+    LightingBlock lighting = {};
+    std::vector<ViewBlock> views;
+
+    explicit SceneUniforms(size_t viewCount = 1) : views(viewCount, ViewBlock{}) {
+        // ranges bound with glBindBufferRange have to start at a multiple of the offset alignment
+        int alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        lightingOffset = alignUp(sizeof(FrameBlock), alignment);
+        viewOffset = alignUp(lightingOffset + sizeof(LightingBlock), alignment);
+        viewStride = alignUp(sizeof(ViewBlock), alignment);
+        multiViewOffset = viewOffset + viewStride * viewCount;
+        staging.assign(multiViewOffset + sizeof(MultiViewBlock), 0);
+
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, staging.size(), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    SceneUniforms(const SceneUniforms &) = delete;
+    SceneUniforms &operator=(const SceneUniforms &) = delete;
+
+    ~SceneUniforms() {
+        glDeleteBuffers(1, &UBO);
+    }
+
+    // writes every block with a single buffer update and binds the frame and lighting blocks
+    void upload() {
+        memcpy(&staging[0], &frame, sizeof(FrameBlock));
+        memcpy(&staging[lightingOffset], &lighting, sizeof(LightingBlock));
+        for (size_t i = 0; i < views.size(); i++)
+            memcpy(&staging[viewOffset + i * viewStride], &views[i], sizeof(ViewBlock));
+        MultiViewBlock *multiView = (MultiViewBlock *)&staging[multiViewOffset];
+        multiView->viewCount = (int)multiViewCount();
+        memcpy(multiView->views, views.data(), multiViewCount() * sizeof(ViewBlock));
+
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, staging.size(), staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_BLOCK_BINDING, UBO, 0, sizeof(FrameBlock));
+        glBindBufferRange(GL_UNIFORM_BUFFER, LIGHTING_BLOCK_BINDING, UBO, lightingOffset, sizeof(LightingBlock));
+        glBindBufferRange(GL_UNIFORM_BUFFER, MULTI_VIEW_BLOCK_BINDING, UBO, multiViewOffset, sizeof(MultiViewBlock));
+    }
+
+    // points the view block binding at the given camera
+    void bindView(size_t view) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, VIEW_BLOCK_BINDING, UBO, viewOffset + view * viewStride, sizeof(ViewBlock));
+    }
+
+    // the views a multi-view pass draws, the first MAX_MULTI_VIEWS
+    size_t multiViewCount() const {
+        return views.size() < (size_t)MAX_MULTI_VIEWS ? views.size() : (size_t)MAX_MULTI_VIEWS;
+    }
+
+   private:
+    unsigned int UBO = 0;
+    size_t lightingOffset, viewOffset, viewStride, multiViewOffset;
+    std::vector<unsigned char> staging;
+
+    static size_t alignUp(size_t value, int alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+};
+
+#endif
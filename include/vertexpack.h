@@ -0,0 +1,139 @@
+#ifndef VERTEXPACK_H
+#define VERTEXPACK_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Compact 24 byte vertex, decoded in shaders/multilight_packed.vs:
+//   position  16 bit snorm, quantized to the bounds of its mesh (scale/offset are per mesh uniforms)
+//   normal    octahedral encoding in two 16 bit snorms
+//   texcoords half floats
+//   tangent   QTangent, the tangent frame as a 16 bit snorm quaternion with the bitangent sign in the sign of w
+struct PackedVertex {
+    int16_t Position[4];  // w is padding so the following attributes stay 4 byte aligned
+    int16_t Normal[2];
+    uint16_t TexCoords[2];
+    int16_t QTangent[4];
+};
+static_assert(sizeof(PackedVertex) == 24, "PackedVertex must match the attribute layout in Mesh::setupMesh");
+
+// maps the bounding box of a mesh onto the [-1, 1] snorm range, decoded = snorm * scale + offset
+struct PackedBounds {
+    glm::vec3 scale = glm::vec3(1.0f);
+    glm::vec3 offset = glm::vec3(0.0f);
+
+    static PackedBounds fromRange(const glm::vec3 &min, const glm::vec3 &max) {
+        PackedBounds bounds;
+        bounds.offset = (min + max) * 0.5f;
+        // flat meshes still need a non zero scale on their flat axis
+        bounds.scale = glm::max((max - min) * 0.5f, glm::vec3(1e-6f));
+        return bounds;
+    }
+};
+
+inline int16_t packSnorm16(float value) {
+    return (int16_t)std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+}
+
+// same rule as GL uses for normalized signed attributes
+inline float unpackSnorm16(int16_t value) {
+    return std::max(value / 32767.0f, -1.0f);
+}
+
+// projects the unit sphere onto an octahedron and unfolds it into the [-1, 1] square
+inline glm::vec2 octEncode(glm::vec3 n) {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (n.z >= 0.0f)
+        return glm::vec2(n.x, n.y);
+    return glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f), (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+inline glm::vec3 octDecode(glm::vec2 e) {
+    glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+// builds the QTangent for a tangent frame, see "Spherical Skinning with Dual Quaternions and QTangents" (Frey, Crytek)
+inline glm::quat encodeQTangent(glm::vec3 normal, glm::vec3 tangent, glm::vec3 bitangent) {
+    normal = glm::normalize(normal);
+    // Gram-Schmidt the tangent against the normal, meshes without texcoords get an arbitrary perpendicular
+    tangent -= normal * glm::dot(normal, tangent);
+    if (glm::dot(tangent, tangent) < 1e-12f)
+        tangent = std::abs(normal.x) < 0.9f ? glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+    tangent = glm::normalize(tangent);
+    glm::vec3 frameBitangent = glm::cross(normal, tangent);
+    bool reflected = glm::dot(frameBitangent, bitangent) < 0.0f;
+
+    glm::quat q = glm::normalize(glm::quat_cast(glm::mat3(tangent, frameBitangent, normal)));
+    if (q.w < 0.0f)
+        q = -q;
+    // w must stay non zero after quantization, otherwise its sign can't carry the reflection
+    const float bias = 1.0f / 32767.0f;
+    if (q.w < bias) {
+        float xyz = std::sqrt(1.0f - bias * bias) / std::max(std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z), 1e-12f);
+        q = glm::quat(bias, q.x * xyz, q.y * xyz, q.z * xyz);
+    }
+    if (reflected)
+        q = -q;
+    return q;
+}
+
+// the inverse of encodeQTangent, the returned frame is orthonormal
+inline void decodeQTangent(glm::quat q, glm::vec3 &normal, glm::vec3 &tangent, glm::vec3 &bitangent) {
+    q = glm::normalize(q);
+    tangent = glm::vec3(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y));
+    normal = glm::vec3(2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+    bitangent = glm::cross(normal, tangent) * (q.w < 0.0f ? -1.0f : 1.0f);
+}
+
+inline PackedVertex packVertex(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &texCoords,
+                               const glm::vec3 &tangent, const glm::vec3 &bitangent, const PackedBounds &bounds) {
+    PackedVertex packed;
+    glm::vec3 local = (position - bounds.offset) / bounds.scale;
+    packed.Position[0] = packSnorm16(local.x);
+    packed.Position[1] = packSnorm16(local.y);
+    packed.Position[2] = packSnorm16(local.z);
+    packed.Position[3] = 0;
+
+    // a zero normal (mesh without normals) encodes as +z instead of dividing by zero
+    glm::vec2 oct = glm::dot(normal, normal) > 0.0f ? octEncode(normal) : glm::vec2(0.0f);
+    packed.Normal[0] = packSnorm16(oct.x);
+    packed.Normal[1] = packSnorm16(oct.y);
+
+    packed.TexCoords[0] = glm::packHalf1x16(texCoords.x);
+    packed.TexCoords[1] = glm::packHalf1x16(texCoords.y);
+
+    glm::quat q = encodeQTangent(glm::dot(normal, normal) > 0.0f ? normal : glm::vec3(0.0f, 0.0f, 1.0f), tangent, bitangent);
+    packed.QTangent[0] = packSnorm16(q.x);
+    packed.QTangent[1] = packSnorm16(q.y);
+    packed.QTangent[2] = packSnorm16(q.z);
+    packed.QTangent[3] = packSnorm16(q.w);
+    return packed;
+}
+
+// CPU reference of the shader decode, used to measure the quantization error
+inline glm::vec3 unpackPosition(const PackedVertex &packed, const PackedBounds &bounds) {
+    glm::vec3 local(unpackSnorm16(packed.Position[0]), unpackSnorm16(packed.Position[1]), unpackSnorm16(packed.Position[2]));
+    return local * bounds.scale + bounds.offset;
+}
+
+inline glm::vec3 unpackNormal(const PackedVertex &packed) {
+    return octDecode(glm::vec2(unpackSnorm16(packed.Normal[0]), unpackSnorm16(packed.Normal[1])));
+}
+
+inline glm::vec2 unpackTexCoords(const PackedVertex &packed) {
+    return glm::vec2(glm::unpackHalf1x16(packed.TexCoords[0]), glm::unpackHalf1x16(packed.TexCoords[1]));
+}
+
+inline glm::quat unpackQTangent(const PackedVertex &packed) {
+    return glm::quat(unpackSnorm16(packed.QTangent[3]), unpackSnorm16(packed.QTangent[0]), unpackSnorm16(packed.QTangent[1]), unpackSnorm16(packed.QTangent[2]));
+}
+
+#endif
@@ -4,7 +4,10 @@
 #define GLFW_DLL
 #include <GLFW/glfw3.h>
 #include <camera.h>
+#include <glfwterminator.h>
 #include <shader.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
 #include <model.h>
 
 #include <glm/glm.hpp>
@@ -62,6 +65,8 @@ int main() {
         return -1;
     }
 
+    GlfwTerminator glfwTerminator;
+
     glViewport(0, 0, WIDTH, HEIGHT);
 
     // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
@@ -70,12 +75,31 @@ int main() {
     // enable depth test
     glEnable(GL_DEPTH_TEST);
 
-    Shader lightingShader("shaders/multilight.vs", "shaders/multilight_alpha.fs");
+    Shader lightingShader("shaders/multilight.vs", "shaders/multilight.fs", ShaderVariants::definesFor(SHADER_DIR_LIGHT | SHADER_SPOT_LIGHT | SHADER_ALPHA_TEST));
 
     Model tree("res/tree/Tree.obj");
     Model ground("res/ground/ground.obj");
     Model chair("res/chair/chair.obj");
 
+    // lights, uploaded together with the camera once per frame
+    SceneUniforms sceneUniforms;
+    sceneUniforms.frame.resolution = glm::vec2(WIDTH, HEIGHT);
+    sceneUniforms.lighting.shininess = 64.0f;
+    sceneUniforms.lighting.dirLight.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
+    sceneUniforms.lighting.dirLight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+    sceneUniforms.lighting.dirLight.diffuse = glm::vec3(0.5f, 0.5f, 0.5);
+    sceneUniforms.lighting.dirLight.specular = glm::vec3(0.05f, 0.05f, 0.05f);
+
+    SpotLightData &spotLight = sceneUniforms.lighting.spotLight;
+    spotLight.cutOff = glm::cos(glm::radians(12.5f));
+    spotLight.outerCutOff = glm::cos(glm::radians(20.0f));
+    spotLight.ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+    spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    spotLight.constant = 1.0f;
+    spotLight.linear = 0.09f;
+    spotLight.quadratic = 0.032f;
+
     glm::vec3 treePositions[] {
         glm::vec3(3.0f, 0.0f, 3.0f),
         glm::vec3(-4.0f, 0.0f, -3.0f),
@@ -109,37 +133,16 @@ int main() {
         // activate shader
         lightingShader.use();
 
-        // set camera pos and material shininess
-        lightingShader.set3f("viewPos", camera.Position);
-        lightingShader.set1f("material.shininess", 64.0f);
-
-        // set directional light uniforms
-        lightingShader.set3f("dirLight.direction", glm::vec3(-0.2f, -1.0f, -0.3f));
-        lightingShader.set3f("dirLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-        lightingShader.set3f("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5));
-        lightingShader.set3f("dirLight.specular", glm::vec3(0.05f, 0.05f, 0.05f));
-
-        // set spotlight uniforms
-        lightingShader.set3f("spotLight.position", camera.Position);
-        lightingShader.set3f("spotLight.direction", camera.Front);
-        lightingShader.set1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        lightingShader.set1f("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
-
-        lightingShader.set3f("spotLight.ambient", glm::vec3(0.1f, 0.1f, 0.1f));
-        lightingShader.set3f("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-        lightingShader.set3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-        lightingShader.set1f("spotLight.constant", 1.0f);
-        lightingShader.set1f("spotLight.linear", 0.09f);
-        lightingShader.set1f("spotLight.quadratic", 0.032f);
-
-        // pass projection matrix to shader
+        // update the camera and spotlight
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-        lightingShader.setmatrix4("projection", projection);
-
-        // pass view transform matrix
         glm::mat4 view = camera.GetViewMatrix();
-        lightingShader.setmatrix4("view", view);
+        sceneUniforms.frame.time = currentFrame;
+        sceneUniforms.frame.deltaTime = deltaTime;
+        spotLight.position = camera.Position;
+        spotLight.direction = camera.Front;
+        sceneUniforms.views[0] = {projection, view, camera.Position, 0.0f};
+        sceneUniforms.upload();
+        sceneUniforms.bindView(0);
 
         glm::mat4 model(1.0f);
         lightingShader.setmatrix4("model", model);
@@ -165,13 +168,10 @@ int main() {
             tree.Draw(lightingShader);
         }
 
-        glBindVertexArray(0);
-
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    glfwTerminate();
     return 0;
 }
 
@@ -254,7 +254,7 @@ unsigned int loadTexture(char const *path) {
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLState::shared().bindTexture(textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -4,7 +4,10 @@
 #define GLFW_DLL
 #include <GLFW/glfw3.h>
 #include <camera.h>
+#include <glfwterminator.h>
 #include <shader.h>
+#include <shaderuniforms.h>
+#include <uniformbuffers.h>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -31,6 +34,9 @@ bool firstMouse = true;
 float deltaTime = 0.0f;  // Time between current frame and last frame
 float lastFrame = 0.0f;  // Time of last frame
 
+// the model matrix is the only uniform left that changes per draw, both programs use multilight.vs
+static constexpr UniformName MODEL = shaderuniforms::multilight_vs::MODEL;
+
 int main() {
     if (!glfwInit()) {
         fprintf(stderr, "Failed to initialize GLFW\n");
@@ -61,6 +67,8 @@ int main() {
         return -1;
     }
 
+    GlfwTerminator glfwTerminator;
+
     glViewport(0, 0, WIDTH, HEIGHT);
 
     // enable depth test
@@ -185,8 +193,38 @@ int main() {
     lightingShader.use();
 
     // set lighting shader uniforms
-    lightingShader.set1i("material.diffuse", 0);
-    lightingShader.set1i("material.specular", 1);
+    lightingShader.set1i(shaderuniforms::multilight_fs::MATERIAL_TEXTURE_DIFFUSE1, 0);
+    lightingShader.set1i(shaderuniforms::multilight_fs::MATERIAL_TEXTURE_SPECULAR1, 1);
+
+    // all lights live in one uniform block, only the spotlight and the camera change per frame
+    SceneUniforms sceneUniforms;
+    sceneUniforms.frame.resolution = glm::vec2(WIDTH, HEIGHT);
+    LightingBlock &lighting = sceneUniforms.lighting;
+    lighting.shininess = 64.0f;
+
+    for (int i = 0; i < 4; i++) {
+        lighting.pointLights[i].position = pointLightPositions[i];
+        lighting.pointLights[i].ambient = pointLightColors[i] * 0.3f;
+        lighting.pointLights[i].diffuse = pointLightColors[i];
+        lighting.pointLights[i].specular = pointLightColors[i];
+        lighting.pointLights[i].constant = 1.0f;
+        lighting.pointLights[i].linear = 0.14f;
+        lighting.pointLights[i].quadratic = 0.07f;
+    }
+
+    lighting.dirLight.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
+    lighting.dirLight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+    lighting.dirLight.diffuse = glm::vec3(0.05f, 0.05f, 0.05);
+    lighting.dirLight.specular = glm::vec3(0.2f, 0.2f, 0.2f);
+
+    lighting.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+    lighting.spotLight.outerCutOff = glm::cos(glm::radians(20.0f));
+    lighting.spotLight.ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    lighting.spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+    lighting.spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    lighting.spotLight.constant = 1.0f;
+    lighting.spotLight.linear = 0.09f;
+    lighting.spotLight.quadratic = 0.032f;
 
     while (!glfwWindowShouldClose(window)) {
         // frame time logic
@@ -204,54 +242,14 @@ int main() {
         // activate shader
         lightingShader.use();
 
-        // set camera pos and material shininess
-        lightingShader.set3f("viewPos", camera.Position);
-        lightingShader.set1f("material.shininess", 64.0f);
-
-        // set point light uniforms
-        for (int i = 0; i < 4; i++) {
-            char buffer[64];
-            sprintf(buffer, "pointLights[%i].position", i);
-            lightingShader.set3f(buffer, pointLightPositions[i]);
-
-            sprintf(buffer, "pointLights[%i].ambient", i);
-            lightingShader.set3f(buffer, pointLightColors[i] * 0.3f);
-
-            sprintf(buffer, "pointLights[%i].diffuse", i);
-            lightingShader.set3f(buffer, pointLightColors[i]);
-
-            sprintf(buffer, "pointLights[%i].specular", i);
-            lightingShader.set3f(buffer, pointLightColors[i]);
-
-            sprintf(buffer, "pointLights[%i].constant", i);
-            lightingShader.set1f(buffer, 1.0f);
-
-            sprintf(buffer, "pointLights[%i].linear", i);
-            lightingShader.set1f(buffer, 0.14f);
-
-            sprintf(buffer, "pointLights[%i].quadratic", i);
-            lightingShader.set1f(buffer, 0.07f);
-        }
-
-        // set directional light uniforms
-        lightingShader.set3f("dirLight.direction", glm::vec3(-0.2f, -1.0f, -0.3f));
-        lightingShader.set3f("dirLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-        lightingShader.set3f("dirLight.diffuse", glm::vec3(0.05f, 0.05f, 0.05));
-        lightingShader.set3f("dirLight.specular", glm::vec3(0.2f, 0.2f, 0.2f));
-
-        // set spotlight uniforms
-        lightingShader.set3f("spotLight.position", camera.Position);
-        lightingShader.set3f("spotLight.direction", camera.Front);
-        lightingShader.set1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        lightingShader.set1f("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
-
-        lightingShader.set3f("spotLight.ambient", glm::vec3(0.1f, 0.1f, 0.1f));
-        lightingShader.set3f("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-        lightingShader.set3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-        lightingShader.set1f("spotLight.constant", 1.0f);
-        lightingShader.set1f("spotLight.linear", 0.09f);
-        lightingShader.set1f("spotLight.quadratic", 0.032f);
+        // camera and spotlight, the light cube shader reads the same view block
+        sceneUniforms.frame.time = currentFrame;
+        sceneUniforms.frame.deltaTime = deltaTime;
+        lighting.spotLight.position = camera.Position;
+        lighting.spotLight.direction = camera.Front;
+        sceneUniforms.views[0] = {glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f), camera.GetViewMatrix(), camera.Position, 0.0f};
+        sceneUniforms.upload();
+        sceneUniforms.bindView(0);
 
         // bind texture
         glActiveTexture(GL_TEXTURE0);
@@ -259,20 +257,12 @@ int main() {
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, specularMap);
 
-        // pass projection matrix to shader
-        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-        lightingShader.setmatrix4("projection", projection);
-
-        // pass view transform matrix
-        glm::mat4 view = camera.GetViewMatrix();
-        lightingShader.setmatrix4("view", view);
-
         for (unsigned int i = 0; i < 10; i++) {
             glm::mat4 model = glm::mat4(1.0f);
             model = glm::translate(model, cubePositions[i]);
             float angle = 20.0f * i;
             model = quatRotation(model, glm::vec3(0.0f, 1.0f, 0.0f), angle);
-            lightingShader.setmatrix4("model", model);
+            lightingShader.setmatrix4(MODEL, model);
 
             glBindVertexArray(VAO);
             glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -280,14 +270,12 @@ int main() {
 
         // change to light cube shader
         lightCubeShader.use();
-        lightCubeShader.setmatrix4("projection", projection);
-        lightCubeShader.setmatrix4("view", view);
 
         for (int i = 0; i < 4; i++) {
             glm::mat4 model(1.0f);
             model = glm::translate(model, pointLightPositions[i]);
             model = glm::scale(model, glm::vec3(0.2f));
-            lightCubeShader.setmatrix4("model", model);
+            lightCubeShader.setmatrix4(MODEL, model);
 
             glBindVertexArray(lightVAO);
             glDrawArrays(GL_TRIANGLES, 0, 36);
@@ -303,7 +291,6 @@ int main() {
     glDeleteVertexArrays(1, &lightVAO);
     glDeleteBuffers(1, &VBO);
 
-    glfwTerminate();
     return 0;
 }
 
@@ -4,7 +4,11 @@
 #define GLFW_DLL
 #include <GLFW/glfw3.h>
 #include <camera.h>
+#include <glfwterminator.h>
+#include <glstate.h>
 #include <shader.h>
+#include <shadervariants.h>
+#include <uniformbuffers.h>
 #include <model.h>
 
 #include <glm/glm.hpp>
@@ -62,21 +66,43 @@ int main() {
         return -1;
     }
 
+    GlfwTerminator glfwTerminator;
+
     glViewport(0, 0, WIDTH, HEIGHT);
 
     // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
     stbi_set_flip_vertically_on_load(true);
 
-    // enable depth test
-    glEnable(GL_DEPTH_TEST);
+    // enable depth test, the state changes go through GLState so the repeated ones are dropped
+    GLState &state = GLState::shared();
+    state.enable(GL_DEPTH_TEST);
 
-    Shader shader("shaders/multilight.vs", "shaders/multilight_alpha.fs");
+    Shader shader("shaders/multilight.vs", "shaders/multilight.fs", ShaderVariants::definesFor(SHADER_DIR_LIGHT | SHADER_SPOT_LIGHT | SHADER_ALPHA_TEST));
     Shader outline("shaders/singlecolor.vs", "shaders/singlecolor.fs");
 
     Model tree("res/tree/Tree.obj");
     Model ground("res/ground/ground.obj");
     Model chair("res/chair/chair.obj");
 
+    // lights, uploaded together with the camera once per frame
+    SceneUniforms sceneUniforms;
+    sceneUniforms.frame.resolution = glm::vec2(WIDTH, HEIGHT);
+    sceneUniforms.lighting.shininess = 64.0f;
+    sceneUniforms.lighting.dirLight.direction = glm::vec3(-0.2f, -1.0f, -0.3f);
+    sceneUniforms.lighting.dirLight.ambient = glm::vec3(0.0f, 0.0f, 0.0f);
+    sceneUniforms.lighting.dirLight.diffuse = glm::vec3(0.5f, 0.5f, 0.5);
+    sceneUniforms.lighting.dirLight.specular = glm::vec3(0.05f, 0.05f, 0.05f);
+
+    SpotLightData &spotLight = sceneUniforms.lighting.spotLight;
+    spotLight.cutOff = glm::cos(glm::radians(12.5f));
+    spotLight.outerCutOff = glm::cos(glm::radians(20.0f));
+    spotLight.ambient = glm::vec3(0.1f, 0.1f, 0.1f);
+    spotLight.diffuse = glm::vec3(1.0f, 1.0f, 1.0f);
+    spotLight.specular = glm::vec3(1.0f, 1.0f, 1.0f);
+    spotLight.constant = 1.0f;
+    spotLight.linear = 0.09f;
+    spotLight.quadratic = 0.032f;
+
     glm::vec3 treePositions[] {
         glm::vec3(3.0f, 0.0f, 3.0f),
         glm::vec3(-4.0f, 0.0f, -3.0f),
@@ -104,8 +130,8 @@ int main() {
         processInput(window);
 
         // enable stencil test
-        glEnable(GL_STENCIL_TEST);
-        glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+        state.enable(GL_STENCIL_TEST);
+        state.stencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
 
         // clear data for render
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -114,43 +140,22 @@ int main() {
         // activate shader
         shader.use();
 
-        // set camera pos and material shininess
-        shader.set3f("viewPos", camera.Position);
-        shader.set1f("material.shininess", 64.0f);
-
-        // set directional light uniforms
-        shader.set3f("dirLight.direction", glm::vec3(-0.2f, -1.0f, -0.3f));
-        shader.set3f("dirLight.ambient", glm::vec3(0.0f, 0.0f, 0.0f));
-        shader.set3f("dirLight.diffuse", glm::vec3(0.5f, 0.5f, 0.5));
-        shader.set3f("dirLight.specular", glm::vec3(0.05f, 0.05f, 0.05f));
-
-        // set spotlight uniforms
-        shader.set3f("spotLight.position", camera.Position);
-        shader.set3f("spotLight.direction", camera.Front);
-        shader.set1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        shader.set1f("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
-
-        shader.set3f("spotLight.ambient", glm::vec3(0.1f, 0.1f, 0.1f));
-        shader.set3f("spotLight.diffuse", glm::vec3(1.0f, 1.0f, 1.0f));
-        shader.set3f("spotLight.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-
-        shader.set1f("spotLight.constant", 1.0f);
-        shader.set1f("spotLight.linear", 0.09f);
-        shader.set1f("spotLight.quadratic", 0.032f);
-
-        // pass projection matrix to shader
+        // update the camera and spotlight
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)WIDTH / (float)HEIGHT, 0.1f, 100.0f);
-        shader.setmatrix4("projection", projection);
-
-        // pass view transform matrix
         glm::mat4 view = camera.GetViewMatrix();
-        shader.setmatrix4("view", view);
+        sceneUniforms.frame.time = currentFrame;
+        sceneUniforms.frame.deltaTime = deltaTime;
+        spotLight.position = camera.Position;
+        spotLight.direction = camera.Front;
+        sceneUniforms.views[0] = {projection, view, camera.Position, 0.0f};
+        sceneUniforms.upload();
+        sceneUniforms.bindView(0);
 
         glm::mat4 model(1.0f);
         shader.setmatrix4("model", model);
 
         // disable stencil writes
-        glStencilMask(0x00);
+        state.stencilMask(0x00);
 
         ground.Draw(shader);
 
@@ -164,8 +169,8 @@ int main() {
         }
 
         // fragment always passes and enable stencil writes
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-        glStencilMask(0xFF);
+        state.stencilFunc(GL_ALWAYS, 1, 0xFF);
+        state.stencilMask(0xFF);
 
         for (unsigned int i = 0; i < 3; i++) {
             model = glm::mat4(1.0f);
@@ -178,9 +183,9 @@ int main() {
         }
 
         // fragment only passes if not written to buffer before
-        glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+        state.stencilFunc(GL_NOTEQUAL, 1, 0xFF);
         // don't write to buffer
-        glStencilMask(0x00);
+        state.stencilMask(0x00);
         // see outline through other objects if disabled
         //glDisable(GL_DEPTH_TEST);
         outline.use();
@@ -198,17 +203,14 @@ int main() {
             chair.Draw(outline);
         }
 
-        glStencilMask(0xFF);
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-        glEnable(GL_DEPTH_TEST);
-
-        glBindVertexArray(0);
+        state.stencilMask(0xFF);
+        state.stencilFunc(GL_ALWAYS, 1, 0xFF);
+        state.enable(GL_DEPTH_TEST);
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    glfwTerminate();
     return 0;
 }
 
@@ -291,7 +293,7 @@ unsigned int loadTexture(char const *path) {
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLState::shared().bindTexture(textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
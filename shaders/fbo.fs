@@ -3,11 +3,19 @@ out vec4 FragColor;
   
 in vec2 TexCoords;
 
-uniform sampler2D screenTexture;
+// one layer per view, see LayeredFramebuffer in include/layeredframebuffer.h
+uniform sampler2DArray screenTexture;
+uniform int layer;
+// the part of the layer that was drawn, dynamic resolution renders less than all of it and it's stretched over the quad
+uniform vec2 renderScale;
 
 const float offset = 1.0 / 300.0;
 
 void main() {
+    // clamped half a texel inside the drawn part, so filtering doesn't pull in what's outside of it
+    vec2 halfTexel = 0.5 / vec2(textureSize(screenTexture, 0).xy);
+    vec2 uv = min(TexCoords * renderScale, renderScale - halfTexel);
+
     vec2 offsets[9] = vec2[](
         vec2(-offset,  offset), // top-left
         vec2( 0.0f,    offset), // top-center
@@ -40,13 +48,13 @@ void main() {
 
     /* vec3 sampleTex[9];
     for (int i = 0; i < 9; i++) {
-        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st + offsets[i]));
+        sampleTex[i] = vec3(texture(screenTexture, vec3(uv + offsets[i], layer)));
     }
     vec3 col = vec3(0.0);
     for (int i = 0; i < 9; i++) {
         col += sampleTex[i] * edgeKernel[i];
     } */
-    vec3 col = vec3(texture(screenTexture, TexCoords));
+    vec3 col = vec3(texture(screenTexture, vec3(uv, layer)));
 
     FragColor = vec4(col, 1.0);
 }
\ No newline at end of file
@@ -1,10 +1,38 @@
 #version 460 core
-out vec4 FragColor;
+// variant values: #defines injected by ShaderVariants (include/shadervariants.h) when built from source, specialization
+// constants when built from SPIR-V (tools/spirvcompile.cpp). without them every light is evaluated.
+// NORMAL_MAP changes the stage interface, so it stays a define and gets its own SPIR-V module.
+#ifdef GL_SPIRV
+layout (constant_id = 0) const int POINT_LIGHT_COUNT = 4;
+layout (constant_id = 1) const int DIR_LIGHT = 1;
+layout (constant_id = 2) const int SPOT_LIGHT = 1;
+layout (constant_id = 3) const int ALPHA_TEST = 0;  // discard below 0.4 alpha, light back faces from their side
+#else
+#ifndef POINT_LIGHT_COUNT
+#define POINT_LIGHT_COUNT 4
+#endif
+#ifndef DIR_LIGHT
+#define DIR_LIGHT 1
+#endif
+#ifndef SPOT_LIGHT
+#define SPOT_LIGHT 1
+#endif
+#ifndef ALPHA_TEST
+#define ALPHA_TEST 0
+#endif
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+
+layout (location = 0) out vec4 FragColor;
 
 struct Material {
     sampler2D texture_diffuse1;
     sampler2D texture_specular1;
-    float shininess;
+#if NORMAL_MAP
+    sampler2D texture_normal1;
+#endif
 };
 
 struct DirLight {
@@ -42,35 +70,63 @@ struct SpotLight {
     float quadratic;
 };
 
-in vec3 FragPos;  
-in vec3 Normal;  
-in vec2 TexCoords;
-  
-uniform vec3 viewPos;
-uniform Material material;
-
-uniform DirLight dirLight;
-#define NR_POINT_LIGHTS 4  
-uniform PointLight pointLights[NR_POINT_LIGHTS];
-uniform SpotLight spotLight;
+// explicit locations, SPIR-V has no names to match them by
+layout (location = 0) in vec3 FragPos;
+layout (location = 1) in vec3 Normal;
+layout (location = 2) in vec2 TexCoords;
+#if NORMAL_MAP
+layout (location = 3) in mat3 TBN;
+#endif
+layout (location = 6) flat in vec3 ViewPos;  // camera of the view being drawn
+
+// the samplers take locations 3 to 5, see MULTILIGHT_UNIFORM_LOCATIONS in include/shadervariants.h
+layout (location = 3) uniform Material material;
+
+// lights shared by all views, see LightingBlock in include/uniformbuffers.h
+#define NR_POINT_LIGHTS 4
+layout (std140, binding = 2) uniform LightingBlock {
+    DirLight dirLight;
+    PointLight pointLights[NR_POINT_LIGHTS];
+    SpotLight spotLight;
+    float shininess;
+};
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 void main() {
+    vec4 texColor = texture(material.texture_diffuse1, TexCoords);
+    if (ALPHA_TEST != 0 && texColor.a < 0.4) discard;
+
+#if NORMAL_MAP
+    // only xy are read, BC5 normal maps don't store z
+    vec2 xy = texture(material.texture_normal1, TexCoords).rg * 2.0 - 1.0;
+    vec3 norm = normalize(TBN * vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))));
+#else
     vec3 norm = normalize(Normal);
-    vec3 viewDir = normalize(viewPos - FragPos);
+#endif
 
-    vec3 result = CalcDirLight(dirLight, norm, viewDir);
+    if (ALPHA_TEST != 0 && !gl_FrontFacing) {
+        norm = -norm;
+    }
+
+    vec3 viewDir = normalize(ViewPos - FragPos);
 
-    for (int i = 0; i < NR_POINT_LIGHTS; i++) {
+    vec3 result = vec3(0.0);
+    if (DIR_LIGHT != 0) {
+        result += CalcDirLight(dirLight, norm, viewDir);
+    }
+
+    for (int i = 0; i < POINT_LIGHT_COUNT; i++) {
         result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
     }
 
-    result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
+    if (SPOT_LIGHT != 0) {
+        result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
+    }
 
-    FragColor = vec4(result, 1.0);
+    FragColor = vec4(result, ALPHA_TEST != 0 ? texColor.a : 1.0);
 }
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir) {
@@ -79,7 +135,7 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir) {
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // combine results
     vec3 ambient = light.ambient * vec3(texture(material.texture_diffuse1, TexCoords));
     vec3 diffuse = light.diffuse * diff * vec3(texture(material.texture_diffuse1, TexCoords));
@@ -93,7 +149,7 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // attenuation
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
@@ -113,7 +169,7 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir) {
     float diff = max(dot(normal, lightDir), 0.0);
     // specular shading
     vec3 reflectDir = reflect(-lightDir, normal);
-    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), shininess);
     // attenuation
     float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
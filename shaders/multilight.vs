@@ -1,21 +1,112 @@
 #version 460 core
+// gl_Layer and gl_ViewportIndex from the vertex shader for MULTI_VIEW, see LayeredFramebuffer in include/layeredframebuffer.h
+#extension GL_ARB_shader_viewport_layer_array : enable
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec3 aTangent;
+layout (location = 4) in vec3 aBitangent;
 
-out vec3 FragPos;
-out vec3 Normal;
-out vec2 TexCoords;
+// INSTANCED reads the model and normal matrices of gl_InstanceID from InstanceBlock instead of the model uniform,
+// MULTI_DRAW only changes multilight_packed.vs, it's declared here so both stages take the same constants.
+// MULTI_VIEW draws every camera of MultiViewBlock in one pass: each instance is repeated per view, the view is
+// gl_InstanceID % viewCount and goes to the layer and viewport of the same index.
+// #defines from ShaderVariants or specialization constants in SPIR-V like the variant values of multilight.fs
+#ifdef GL_SPIRV
+layout (constant_id = 4) const int INSTANCED = 0;
+layout (constant_id = 5) const int MULTI_DRAW = 0;
+layout (constant_id = 6) const int MULTI_VIEW = 0;
+#else
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+#ifndef MULTI_DRAW
+#define MULTI_DRAW 0
+#endif
+#ifndef MULTI_VIEW
+#define MULTI_VIEW 0
+#endif
+// without the extension gl_Layer can't be written and every view would land in layer 0
+#if MULTI_VIEW && !defined(GL_ARB_shader_viewport_layer_array)
+#error MULTI_VIEW needs GL_ARB_shader_viewport_layer_array
+#endif
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// explicit locations, SPIR-V has no names to match them by
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec3 Normal;
+layout (location = 2) out vec2 TexCoords;
+#if NORMAL_MAP
+layout (location = 3) out mat3 TBN;
+#endif
+layout (location = 6) flat out vec3 ViewPos;
+
+layout (location = 0) uniform mat4 model;
+
+// per instance transforms, see InstanceData in include/instancebuffer.h
+struct Instance {
+    mat4 model;
+    mat3 normalMatrix;  // transpose(inverse(mat3(model))), computed once per instance on the CPU
+};
+layout (std430, binding = 0) readonly buffer InstanceBlock {
+    Instance instances[];
+};
+
+// camera of the view being drawn, see ViewBlock in include/uniformbuffers.h
+layout (std140, binding = 1) uniform ViewBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+// every camera of a multi-view pass, see MultiViewBlock in include/uniformbuffers.h
+#define MAX_MULTI_VIEWS 8
+struct View {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+layout (std140, binding = 3) uniform MultiViewBlock {
+    View views[MAX_MULTI_VIEWS];
+    int viewCount;
+};
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
+    int viewIndex = 0, instance = gl_InstanceID;
+    if (MULTI_VIEW != 0) {
+        viewIndex = gl_InstanceID % viewCount;
+        instance = gl_InstanceID / viewCount;
+    }
+
+    mat4 transform = model;
+    mat3 normalMatrix;
+    if (INSTANCED != 0) {
+        transform = instances[instance].model;
+        normalMatrix = instances[instance].normalMatrix;
+    } else {
+        normalMatrix = mat3(transpose(inverse(transform)));
+    }
+    FragPos = vec3(transform * vec4(aPos, 1.0));
+    Normal = normalMatrix * aNormal;
     TexCoords = aTexCoords;
-    
-    gl_Position = projection * view * vec4(FragPos, 1.0);
+#if NORMAL_MAP
+    TBN = mat3(normalize(mat3(transform) * aTangent), normalize(mat3(transform) * aBitangent), normalize(Normal));
+#endif
+
+    if (MULTI_VIEW != 0) {
+        gl_Position = views[viewIndex].projection * views[viewIndex].view * vec4(FragPos, 1.0);
+        ViewPos = views[viewIndex].viewPos;
+#ifdef GL_ARB_shader_viewport_layer_array
+        gl_Layer = viewIndex;
+        // each view has its own viewport, dynamic resolution draws them at different sizes
+        gl_ViewportIndex = viewIndex;
+#endif
+    } else {
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+        ViewPos = viewPos;
+    }
 }
\ No newline at end of file
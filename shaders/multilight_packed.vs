@@ -0,0 +1,148 @@
+#version 460 core
+// gl_Layer and gl_ViewportIndex from the vertex shader for MULTI_VIEW, see LayeredFramebuffer in include/layeredframebuffer.h
+#extension GL_ARB_shader_viewport_layer_array : enable
+// multilight.vs for meshes uploaded with VERTEX_FORMAT_PACKED, see include/vertexpack.h
+layout (location = 0) in vec3 aPos;       // snorm16 in the mesh bounds
+layout (location = 1) in vec2 aNormal;    // octahedral snorm16
+layout (location = 2) in vec2 aTexCoords; // half floats, already expanded by the vertex fetch
+layout (location = 3) in vec4 aQTangent;  // snorm16 quaternion, w < 0 flips the bitangent
+
+// INSTANCED reads the model and normal matrices of gl_InstanceID from InstanceBlock instead of the model uniform,
+// MULTI_DRAW the mesh bounds of the draw from MeshBlock instead of the positionScale and positionOffset uniforms.
+// MULTI_VIEW draws every camera of MultiViewBlock in one pass: each instance is repeated per view, the view is
+// gl_InstanceID % viewCount and goes to the layer and viewport of the same index.
+// #defines from ShaderVariants or specialization constants in SPIR-V like the variant values of multilight.fs
+#ifdef GL_SPIRV
+layout (constant_id = 4) const int INSTANCED = 0;
+layout (constant_id = 5) const int MULTI_DRAW = 0;
+layout (constant_id = 6) const int MULTI_VIEW = 0;
+#else
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+#ifndef MULTI_DRAW
+#define MULTI_DRAW 0
+#endif
+#ifndef MULTI_VIEW
+#define MULTI_VIEW 0
+#endif
+// without the extension gl_Layer can't be written and every view would land in layer 0
+#if MULTI_VIEW && !defined(GL_ARB_shader_viewport_layer_array)
+#error MULTI_VIEW needs GL_ARB_shader_viewport_layer_array
+#endif
+#endif
+#ifndef NORMAL_MAP
+#define NORMAL_MAP 0
+#endif
+
+// explicit locations, SPIR-V has no names to match them by
+layout (location = 0) out vec3 FragPos;
+layout (location = 1) out vec3 Normal;
+layout (location = 2) out vec2 TexCoords;
+#if NORMAL_MAP
+layout (location = 3) out mat3 TBN;
+#endif
+layout (location = 6) flat out vec3 ViewPos;
+
+layout (location = 0) uniform mat4 model;
+
+// per instance transforms, see InstanceData in include/instancebuffer.h
+struct Instance {
+    mat4 model;
+    mat3 normalMatrix;  // transpose(inverse(mat3(model))), computed once per instance on the CPU
+};
+layout (std430, binding = 0) readonly buffer InstanceBlock {
+    Instance instances[];
+};
+
+// camera of the view being drawn, see ViewBlock in include/uniformbuffers.h
+layout (std140, binding = 1) uniform ViewBlock {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+
+// every camera of a multi-view pass, see MultiViewBlock in include/uniformbuffers.h
+#define MAX_MULTI_VIEWS 8
+struct View {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPos;
+};
+layout (std140, binding = 3) uniform MultiViewBlock {
+    View views[MAX_MULTI_VIEWS];
+    int viewCount;
+};
+
+layout (location = 1) uniform vec3 positionScale;
+layout (location = 2) uniform vec3 positionOffset;
+
+// bounds of every mesh in a MeshBuffer, a multi-draw points gl_BaseInstance at the one of each draw. see include/meshbuffer.h
+struct MeshBounds {
+    vec4 scale;  // xyz
+    vec4 offset;
+};
+layout (std430, binding = 1) readonly buffer MeshBlock {
+    MeshBounds meshBounds[];
+};
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// tangent frame from a QTangent, used by the NORMAL_MAP variant
+mat3 qtangentToTBN(vec4 q)
+{
+    q = normalize(q);
+    vec3 tangent = vec3(1.0 - 2.0 * (q.y * q.y + q.z * q.z), 2.0 * (q.x * q.y + q.w * q.z), 2.0 * (q.x * q.z - q.w * q.y));
+    vec3 normal = vec3(2.0 * (q.x * q.z + q.w * q.y), 2.0 * (q.y * q.z - q.w * q.x), 1.0 - 2.0 * (q.x * q.x + q.y * q.y));
+    vec3 bitangent = cross(normal, tangent) * (q.w < 0.0 ? -1.0 : 1.0);
+    return mat3(tangent, bitangent, normal);
+}
+
+void main()
+{
+    vec3 position;
+    if (MULTI_DRAW != 0)
+        position = aPos * meshBounds[gl_BaseInstance].scale.xyz + meshBounds[gl_BaseInstance].offset.xyz;
+    else
+        position = aPos * positionScale + positionOffset;
+    int viewIndex = 0, instance = gl_InstanceID;
+    if (MULTI_VIEW != 0) {
+        viewIndex = gl_InstanceID % viewCount;
+        instance = gl_InstanceID / viewCount;
+    }
+
+    mat4 transform = model;
+    mat3 normalMatrix;
+    if (INSTANCED != 0) {
+        transform = instances[instance].model;
+        normalMatrix = instances[instance].normalMatrix;
+    } else {
+        normalMatrix = mat3(transpose(inverse(transform)));
+    }
+    FragPos = vec3(transform * vec4(position, 1.0));
+    Normal = normalMatrix * octDecode(aNormal);
+    TexCoords = aTexCoords;
+#if NORMAL_MAP
+    mat3 tangentFrame = qtangentToTBN(aQTangent);
+    TBN = mat3(normalize(mat3(transform) * tangentFrame[0]), normalize(mat3(transform) * tangentFrame[1]), normalize(normalMatrix * tangentFrame[2]));
+#endif
+
+    if (MULTI_VIEW != 0) {
+        gl_Position = views[viewIndex].projection * views[viewIndex].view * vec4(FragPos, 1.0);
+        ViewPos = views[viewIndex].viewPos;
+#ifdef GL_ARB_shader_viewport_layer_array
+        gl_Layer = viewIndex;
+        // each view has its own viewport, dynamic resolution draws them at different sizes
+        gl_ViewportIndex = viewIndex;
+#endif
+    } else {
+        gl_Position = projection * view * vec4(FragPos, 1.0);
+        ViewPos = viewPos;
+    }
+}
@@ -0,0 +1,125 @@
+// Offline texture compressor: encodes images to BC1/BC3/BC5/BC7 with a full mip chain and writes them as
+// KTX2 files next to the source (image.png -> image.ktx2), which TextureFromFile then picks up instead of the image.
+// Runs without a GL context and reports encoder throughput and PSNR of the top level per file.
+//
+// usage: ktxencode [--format auto|bc1|bc3|bc5|bc7] [--srgb] [--no-flip] images...
+//   auto picks BC1 for opaque images and BC3 for images with alpha.
+//   images are flipped vertically by default to match stbi_set_flip_vertically_on_load(true).
+#include <bcencode.h>
+#include <ktx2.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+static const char *formatName(BlockFormat format) {
+    switch (format) {
+        case BLOCK_BC1:
+            return "BC1";
+        case BLOCK_BC3:
+            return "BC3";
+        case BLOCK_BC5:
+            return "BC5";
+        case BLOCK_BC7:
+            return "BC7";
+    }
+    return "?";
+}
+
+int main(int argc, char **argv) {
+    bool autoFormat = true, srgb = false, flip = true;
+    BlockFormat format = BLOCK_BC1;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            std::string name = argv[++i];
+            autoFormat = name == "auto";
+            if (name == "bc1")
+                format = BLOCK_BC1;
+            else if (name == "bc3")
+                format = BLOCK_BC3;
+            else if (name == "bc5")
+                format = BLOCK_BC5;
+            else if (name == "bc7")
+                format = BLOCK_BC7;
+            else if (!autoFormat) {
+                fprintf(stderr, "unknown format %s\n", name.c_str());
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--srgb") == 0) {
+            srgb = true;
+        } else if (std::strcmp(argv[i], "--no-flip") == 0) {
+            flip = false;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    if (inputs.empty()) {
+        fprintf(stderr, "usage: ktxencode [--format auto|bc1|bc3|bc5|bc7] [--srgb] [--no-flip] images...\n");
+        return 1;
+    }
+
+    stbi_set_flip_vertically_on_load(flip);
+    printf("%-40s %6s %11s %10s %10s %9s\n", "image", "format", "size", "MPix/s", "PSNR (dB)", "ratio");
+    int failures = 0;
+    for (const std::string &input : inputs) {
+        int width, height, components;
+        unsigned char *data = stbi_load(input.c_str(), &width, &height, &components, 4);
+        if (!data) {
+            fprintf(stderr, "failed to load %s: %s\n", input.c_str(), stbi_failure_reason());
+            failures++;
+            continue;
+        }
+        BlockFormat chosen = format;
+        if (autoFormat) {
+            chosen = BLOCK_BC1;
+            for (size_t i = 0; i < (size_t)width * height; i++) {
+                if (data[i * 4 + 3] != 255) {
+                    chosen = BLOCK_BC3;
+                    break;
+                }
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::vector<uint8_t>> levels;
+        std::vector<uint8_t> level(data, data + (size_t)width * height * 4);
+        int levelWidth = width, levelHeight = height;
+        double pixels = 0.0;
+        while (true) {
+            levels.push_back(compressImage(level.data(), levelWidth, levelHeight, chosen));
+            pixels += (double)levelWidth * levelHeight;
+            if (levelWidth == 1 && levelHeight == 1)
+                break;
+            int nextWidth, nextHeight;
+            level = downsampleImage(level.data(), levelWidth, levelHeight, nextWidth, nextHeight);
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::vector<uint8_t> decoded = decompressImage(levels[0].data(), width, height, chosen);
+        double psnr = computePSNR(data, decoded.data(), width, height, chosen);
+
+        std::string output = ktx2PathFor(input);
+        if (output == input || !writeKtx2(output, chosen, srgb, width, height, levels)) {
+            fprintf(stderr, "failed to write %s\n", output.c_str());
+            failures++;
+        }
+
+        size_t compressedBytes = 0;
+        for (const std::vector<uint8_t> &compressed : levels)
+            compressedBytes += compressed.size();
+        double uncompressedBytes = pixels * (components == 4 ? 4 : 3);
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", width, height);
+        printf("%-40s %6s %11s %10.2f %10.2f %8.1f:1\n", input.c_str(), formatName(chosen), size, pixels / seconds / 1e6, psnr,
+               uncompressedBytes / compressedBytes);
+        stbi_image_free(data);
+    }
+    return failures == 0 ? 0 : 1;
+}
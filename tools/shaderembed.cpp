@@ -0,0 +1,189 @@
+// Shader embedder: turns the GLSL files of a directory into two generated headers.
+//   embeddedshaders.h  every source as a constexpr string, Shader reads these instead of the files
+//   shaderuniforms.h   per shader a namespace of UniformName constants for its default block uniforms, struct members
+//                      flattened (shaderuniforms::multilight_fs::MATERIAL_TEXTURE_DIFFUSE1), so a misspelled name
+//                      doesn't compile instead of silently setting location -1
+// Run it again after editing a shader, until then the executables keep the old copy (see Shader::readSource for
+// reading the files instead while developing).
+//
+// usage: shaderembed [shader directory] [output directory], defaults shaders and include. run from the repository root
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const char *const DELIMITER = "SHADER";
+
+struct Member {
+    std::string type, name, arraySize;
+};
+
+static std::string readFile(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static std::string stripComments(const std::string &source) {
+    std::string code = std::regex_replace(source, std::regex("/\\*[\\s\\S]*?\\*/"), " ");
+    return std::regex_replace(code, std::regex("//[^\\n]*"), "");
+}
+
+// positionScale -> POSITION_SCALE, material.texture_diffuse1 -> MATERIAL_TEXTURE_DIFFUSE1
+static std::string constantName(const std::string &uniform) {
+    std::string name;
+    for (size_t i = 0; i < uniform.size(); i++) {
+        char c = uniform[i];
+        if (std::isupper((unsigned char)c) && i > 0 && (std::islower((unsigned char)uniform[i - 1]) || std::isdigit((unsigned char)uniform[i - 1])))
+            name += '_';
+        if (std::isalnum((unsigned char)c))
+            name += (char)std::toupper((unsigned char)c);
+        else if (name.empty() || name.back() != '_')
+            name += '_';
+    }
+    while (!name.empty() && name.back() == '_')
+        name.pop_back();
+    return name;
+}
+
+// multilight_packed.vs -> multilight_packed_vs, 1.model_loading.vs -> shader_1_model_loading_vs
+static std::string namespaceName(const std::string &file) {
+    std::string name;
+    for (char c : file)
+        name += std::isalnum((unsigned char)c) ? (char)std::tolower((unsigned char)c) : '_';
+    return std::isdigit((unsigned char)name[0]) ? "shader_" + name : name;
+}
+
+// array size from a literal or a "#define NAME value" of the same file, 0 when it can't be told
+static int arrayLength(const std::string &size, const std::map<std::string, std::string> &defines) {
+    std::string value = size;
+    auto define = defines.find(size);
+    if (define != defines.end())
+        value = define->second;
+    return !value.empty() && std::all_of(value.begin(), value.end(), ::isdigit) ? std::stoi(value) : 0;
+}
+
+// the names glGetUniformLocation accepts for a uniform, struct members and struct array elements spelled out
+static void uniformNames(const Member &uniform, const std::string &prefix, const std::map<std::string, std::vector<Member>> &structs,
+                         const std::map<std::string, std::string> &defines, std::vector<std::string> &names) {
+    std::string name = prefix + uniform.name;
+    auto structType = structs.find(uniform.type);
+    if (structType == structs.end()) {
+        names.push_back(name);  // arrays of plain types register their base name, see Shader::reflectUniforms
+        return;
+    }
+    std::vector<std::string> elements;
+    if (uniform.arraySize.empty()) {
+        elements.push_back(name);
+    } else {
+        int length = arrayLength(uniform.arraySize, defines);
+        for (int i = 0; i < length; i++)
+            elements.push_back(name + "[" + std::to_string(i) + "]");
+    }
+    for (const std::string &element : elements) {
+        for (const Member &member : structType->second)
+            uniformNames(member, element + ".", structs, defines, names);
+    }
+}
+
+// default block uniforms of a shader. every #if branch counts, the constants cover all variants
+static std::vector<std::string> findUniforms(const std::string &source) {
+    std::string code = stripComments(source);
+    static const std::regex defineRegex("#define\\s+(\\w+)\\s+(\\w+)");
+    static const std::regex structRegex("struct\\s+(\\w+)\\s*\\{([^}]*)\\}\\s*;");
+    static const std::regex memberRegex("(\\w+)\\s+(\\w+)\\s*(?:\\[\\s*(\\w+)\\s*\\])?\\s*;");
+    static const std::regex uniformRegex("(?:layout\\s*\\([^)]*\\)\\s*)?\\buniform\\s+(\\w+)\\s+(\\w+)\\s*(?:\\[\\s*(\\w+)\\s*\\])?\\s*;");
+
+    std::map<std::string, std::string> defines;
+    for (std::sregex_iterator it(code.begin(), code.end(), defineRegex), end; it != end; ++it)
+        defines[(*it)[1]] = (*it)[2];
+    std::map<std::string, std::vector<Member>> structs;
+    for (std::sregex_iterator it(code.begin(), code.end(), structRegex), end; it != end; ++it) {
+        std::string body = (*it)[2];
+        std::vector<Member> &members = structs[(*it)[1]];
+        for (std::sregex_iterator member(body.begin(), body.end(), memberRegex); member != end; ++member)
+            members.push_back({(*member)[1], (*member)[2], (*member)[3]});
+    }
+
+    std::vector<std::string> names;
+    for (std::sregex_iterator it(code.begin(), code.end(), uniformRegex), end; it != end; ++it)
+        uniformNames({(*it)[1], (*it)[2], (*it)[3]}, "", structs, defines, names);
+    std::vector<std::string> unique;
+    for (const std::string &name : names) {
+        if (std::find(unique.begin(), unique.end(), name) == unique.end())
+            unique.push_back(name);
+    }
+    return unique;
+}
+
+static bool writeIfChanged(const std::filesystem::path &path, const std::string &contents) {
+    if (readFile(path) == contents)
+        return true;
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+    return (bool)out;
+}
+
+int main(int argc, char **argv) {
+    std::string shaderDirectory = argc > 1 ? argv[1] : "shaders";
+    std::filesystem::path outputDirectory = argc > 2 ? argv[2] : "include";
+
+    std::vector<std::filesystem::path> files;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(shaderDirectory, error)) {
+        std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && (extension == ".vs" || extension == ".fs"))
+            files.push_back(entry.path());
+    }
+    if (files.empty()) {
+        fprintf(stderr, "no .vs or .fs files in %s\n", shaderDirectory.c_str());
+        return 1;
+    }
+    // stable output, independent of the directory order
+    std::sort(files.begin(), files.end());
+
+    std::ostringstream sources, uniforms;
+    sources << "// generated by tools/shaderembed from " << shaderDirectory << "/, don't edit\n"
+            << "#ifndef EMBEDDEDSHADERS_H\n#define EMBEDDEDSHADERS_H\n\n#include <string_view>\n\n"
+            << "struct EmbeddedShader {\n    const char *path;\n    std::string_view source;\n};\n\n"
+            << "inline constexpr EmbeddedShader EMBEDDED_SHADERS[] = {\n";
+    uniforms << "// generated by tools/shaderembed from " << shaderDirectory << "/, don't edit\n"
+             << "#ifndef SHADERUNIFORMS_H\n#define SHADERUNIFORMS_H\n\n#include <shader.h>\n\n"
+             << "// default block uniforms of every shader file, struct members flattened\n"
+             << "namespace shaderuniforms {\n";
+
+    size_t uniformCount = 0;
+    for (const std::filesystem::path &file : files) {
+        std::string source = readFile(file);
+        std::string path = shaderDirectory + "/" + file.filename().string();
+        if (source.find(std::string(")") + DELIMITER + "\"") != std::string::npos) {
+            fprintf(stderr, "%s contains the raw string delimiter %s\n", path.c_str(), DELIMITER);
+            return 1;
+        }
+        sources << "    {\"" << path << "\", R\"" << DELIMITER << "(" << source << ")" << DELIMITER << "\"},\n";
+
+        uniforms << "\nnamespace " << namespaceName(file.filename().string()) << " {\n";
+        for (const std::string &name : findUniforms(source)) {
+            uniforms << "constexpr UniformName " << constantName(name) << "(\"" << name << "\");\n";
+            uniformCount++;
+        }
+        uniforms << "}  // namespace " << namespaceName(file.filename().string()) << "\n";
+    }
+    sources << "};\n\n#endif\n";
+    uniforms << "\n}  // namespace shaderuniforms\n\n#endif\n";
+
+    if (!writeIfChanged(outputDirectory / "embeddedshaders.h", sources.str()) ||
+        !writeIfChanged(outputDirectory / "shaderuniforms.h", uniforms.str())) {
+        fprintf(stderr, "failed to write the headers to %s\n", outputDirectory.string().c_str());
+        return 1;
+    }
+    printf("%zu shaders, %zu uniforms\n", files.size(), uniformCount);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Offline SPIR-V compiler: runs glslangValidator (-G, SPIR-V for OpenGL) over GLSL shaders and writes the modules
+// where Shader::spirvPathFor expects them (shaders/x.fs -> shaders/spirv/x.fs.spv). Sources that use NORMAL_MAP
+// also get a module compiled with NORMAL_MAP 1 (shaders/spirv/x.fs.normalmap.spv), see ShaderVariants.
+// Only shaders with explicit locations for their inputs, outputs and default block uniforms can be compiled,
+// the others are reported and skipped. Needs glslangValidator from the Vulkan SDK (or glslang) on the PATH.
+//
+// usage: spirvcompile [shaders...], default every .vs and .fs file in shaders/. run from the repository root
+#include <shader.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define DEVNULL "NUL"
+#else
+#define DEVNULL "/dev/null"
+#endif
+
+// glslangValidator picks the stage from .vert/.frag, these shaders use .vs/.fs
+static const char *stageFor(const std::string &path) {
+    std::string extension = std::filesystem::path(path).extension().string();
+    if (extension == ".vs")
+        return "vert";
+    if (extension == ".fs")
+        return "frag";
+    return NULL;
+}
+
+static bool compile(const std::string &source, const char *stage, const std::string &defines, const std::string &output) {
+    std::string command = "glslangValidator -G -S " + std::string(stage) + defines + " -o \"" + output + "\" \"" + source + "\"";
+    return std::system(command.c_str()) == 0;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; i++)
+        inputs.push_back(argv[i]);
+    if (inputs.empty()) {
+        std::error_code error;
+        for (const auto &entry : std::filesystem::directory_iterator("shaders", error)) {
+            if (entry.is_regular_file() && stageFor(entry.path().string()))
+                inputs.push_back("shaders/" + entry.path().filename().string());
+        }
+    }
+    if (std::system("glslangValidator --version > " DEVNULL " 2>&1") != 0) {
+        fprintf(stderr, "glslangValidator not found, install the Vulkan SDK or glslang\n");
+        return 1;
+    }
+
+    int compiled = 0, failed = 0;
+    for (const std::string &input : inputs) {
+        const char *stage = stageFor(input);
+        std::ifstream file(input);
+        if (!stage || !file) {
+            fprintf(stderr, "%s: not a readable .vs or .fs file\n", input.c_str());
+            failed++;
+            continue;
+        }
+        std::string source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::create_directories(std::filesystem::path(Shader::spirvPathFor(input)).parent_path());
+
+        std::vector<std::pair<std::string, std::string>> modules = {{"", ""}};  // variant name, extra defines
+        if (source.find("NORMAL_MAP") != std::string::npos)
+            modules.push_back({"normalmap", " -DNORMAL_MAP=1"});
+        for (const auto &module : modules) {
+            std::string output = Shader::spirvPathFor(input, module.first);
+            if (compile(input, stage, module.second, output)) {
+                printf("%s -> %s\n", input.c_str(), output.c_str());
+                compiled++;
+            } else {
+                fprintf(stderr, "%s: skipped, see the errors above\n", output.c_str());
+                failed++;
+            }
+        }
+    }
+    printf("%d modules compiled, %d failed\n", compiled, failed);
+    return failed > 0 && compiled == 0 ? 1 : 0;
+}